@@ -0,0 +1,328 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "event-queue/EventQueue.hh"
+
+/**
+ * Standalone microbenchmark of EventQueue (add_event + proceed).
+ *
+ * Workloads:
+ *   - hold model: the queue holds a fixed number of pending events; each
+ *     event, when run, schedules one new event after a random increment
+ *     (exponential, uniform, or bimodal distribution).
+ *   - outliers: hold model where 1% of the increments are long-horizon
+ *     (up to 10 ms) events, which stay in the queue for the whole run.
+ *   - burst: concurrent collectives, each step scheduling a burst of
+ *     events at the same time_stamp, the next step starting when all the
+ *     events of the current step have run.
+ *
+ * Usage: AnalyticalEventQueueBenchmark [events_count]
+ */
+
+namespace {
+/**
+ * number of global allocations so far
+ */
+uint64_t allocations_count = 0;
+} // namespace
+
+void* operator new(size_t size) {
+  allocations_count++;
+  if (auto ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+using Analytical::Event;
+using Analytical::EventQueue;
+using Analytical::TimeStamp;
+
+/**
+ * Random increment (in ps) between an event and the event it schedules.
+ */
+typedef TimeStamp (*Increment)(std::mt19937_64& rng);
+
+TimeStamp exponential_increment(std::mt19937_64& rng) {
+  std::exponential_distribution<double> distribution(1.0 / 1000);
+  return (TimeStamp)distribution(rng);
+}
+
+TimeStamp uniform_increment(std::mt19937_64& rng) {
+  std::uniform_int_distribution<TimeStamp> distribution(0, 2000);
+  return distribution(rng);
+}
+
+TimeStamp bimodal_increment(std::mt19937_64& rng) {
+  // 90% short (on-chip) and 10% long (cross-node) delays
+  std::bernoulli_distribution is_long(0.1);
+  return is_long(rng) ? 9000 + uniform_increment(rng)
+                      : uniform_increment(rng) / 10;
+}
+
+TimeStamp outlier_increment(std::mt19937_64& rng) {
+  std::bernoulli_distribution is_outlier(0.01);
+  if (is_outlier(rng)) {
+    std::uniform_int_distribution<TimeStamp> distribution(
+        1'000'000'000, 10'000'000'000);
+    return distribution(rng);
+  }
+  return exponential_increment(rng);
+}
+
+/**
+ * Measurement of one workload run.
+ */
+struct Result {
+  uint64_t events_count = 0;
+  uint64_t peak_queue_size = 0;
+  uint64_t allocations_count = 0;
+  double elapsed_ns = 0;
+};
+
+/**
+ * Bookkeeping shared by every workload.
+ */
+class Workload {
+ public:
+  explicit Workload(EventQueue::SchedulerType scheduler_type) noexcept
+      : event_queue(scheduler_type) {}
+
+  /**
+   * Run the event queue until it is empty, measuring the run.
+   * @return measurement
+   */
+  Result measure() noexcept {
+    auto allocations_count_before = allocations_count;
+    auto start = std::chrono::steady_clock::now();
+
+    while (!event_queue.empty()) {
+      event_queue.proceed();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    result.allocations_count = allocations_count - allocations_count_before;
+    result.elapsed_ns =
+        (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            end - start)
+            .count();
+    return result;
+  }
+
+ protected:
+  EventQueue event_queue;
+  Result result;
+  uint64_t queue_size = 0;
+
+  void schedule(TimeStamp time_stamp, const Event& event) noexcept {
+    event_queue.add_event(time_stamp, event);
+    queue_size++;
+    result.peak_queue_size = std::max(result.peak_queue_size, queue_size);
+  }
+
+  void count_run_event() noexcept {
+    queue_size--;
+    result.events_count++;
+  }
+};
+
+/**
+ * Classic hold model: every run event schedules exactly one new event.
+ */
+class HoldModel : public Workload {
+ public:
+  HoldModel(
+      EventQueue::SchedulerType scheduler_type,
+      Increment increment,
+      uint64_t hold_size,
+      uint64_t events_count) noexcept
+      : Workload(scheduler_type),
+        increment(increment),
+        events_count(events_count) {
+    for (uint64_t i = 0; i < hold_size; i++) {
+      schedule_next();
+    }
+  }
+
+ private:
+  std::mt19937_64 rng{0};
+  Increment increment;
+  uint64_t events_count;
+  uint64_t scheduled_events_count = 0;
+
+  void schedule_next() noexcept {
+    if (scheduled_events_count == events_count) {
+      return;
+    }
+    scheduled_events_count++;
+    auto time_stamp = event_queue.get_current_time() + (*increment)(rng);
+    schedule(time_stamp, Event([this]() { hold(); }));
+  }
+
+  void hold() noexcept {
+    count_run_event();
+    schedule_next();
+  }
+};
+
+/**
+ * Concurrent collectives, each step being a burst of same-time_stamp events.
+ */
+class BurstModel : public Workload {
+ public:
+  BurstModel(
+      EventQueue::SchedulerType scheduler_type,
+      int collectives_count,
+      int burst_size,
+      uint64_t events_count) noexcept
+      : Workload(scheduler_type),
+        burst_size(burst_size),
+        steps_count(events_count / collectives_count / burst_size) {
+    collectives.resize(collectives_count);
+    for (auto i = 0; i < collectives_count; i++) {
+      // distinct step latencies interleave the collectives
+      collectives[i].step_latency = 1000 + 37 * i;
+      start_step(i);
+    }
+  }
+
+ private:
+  struct Collective {
+    TimeStamp step_latency = 0;
+    uint64_t finished_steps_count = 0;
+    int remaining_events_count = 0;
+  };
+
+  int burst_size;
+  uint64_t steps_count;
+  std::vector<Collective> collectives;
+
+  void start_step(int id) noexcept {
+    auto& collective = collectives[id];
+    collective.remaining_events_count = burst_size;
+    auto time_stamp =
+        event_queue.get_current_time() + collective.step_latency;
+    for (auto i = 0; i < burst_size; i++) {
+      schedule(time_stamp, Event([this, id]() { finish_event(id); }));
+    }
+  }
+
+  void finish_event(int id) noexcept {
+    count_run_event();
+
+    auto& collective = collectives[id];
+    collective.remaining_events_count--;
+    if (collective.remaining_events_count > 0) {
+      return;
+    }
+
+    collective.finished_steps_count++;
+    if (collective.finished_steps_count < steps_count) {
+      start_step(id);
+    }
+  }
+};
+
+void print_result(
+    const std::string& workload,
+    EventQueue::SchedulerType scheduler_type,
+    const Result& result) noexcept {
+  auto scheduler =
+      (scheduler_type == EventQueue::SchedulerType::Heap) ? "Heap" : "List";
+  std::printf(
+      "%-28s %-6s %12llu %10.1f %12llu %12llu\n",
+      workload.c_str(),
+      scheduler,
+      (unsigned long long)result.events_count,
+      result.elapsed_ns / std::max<uint64_t>(result.events_count, 1),
+      (unsigned long long)result.peak_queue_size,
+      (unsigned long long)result.allocations_count);
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  auto events_count = (uint64_t)200'000;
+  if (argc > 1) {
+    events_count = std::stoull(argv[1]);
+  }
+
+  std::printf(
+      "%-28s %-6s %12s %10s %12s %12s\n",
+      "Workload",
+      "Queue",
+      "Events",
+      "ns/op",
+      "PeakSize",
+      "Allocations");
+
+  const EventQueue::SchedulerType scheduler_types[] = {
+      EventQueue::SchedulerType::Heap, EventQueue::SchedulerType::List};
+
+  struct HoldWorkload {
+    const char* name;
+    Increment increment;
+    uint64_t hold_size;
+  };
+  const HoldWorkload hold_workloads[] = {
+      {"hold/exponential/64", exponential_increment, 64},
+      {"hold/exponential/4096", exponential_increment, 4096},
+      {"hold/uniform/4096", uniform_increment, 4096},
+      {"hold/bimodal/4096", bimodal_increment, 4096},
+      {"hold/outliers/4096", outlier_increment, 4096},
+  };
+
+  for (const auto& hold_workload : hold_workloads) {
+    for (auto scheduler_type : scheduler_types) {
+      auto workload = HoldModel(
+          scheduler_type,
+          hold_workload.increment,
+          hold_workload.hold_size,
+          events_count);
+      print_result(hold_workload.name, scheduler_type, workload.measure());
+    }
+  }
+
+  struct BurstWorkload {
+    const char* name;
+    int collectives_count;
+    int burst_size;
+  };
+  const BurstWorkload burst_workloads[] = {
+      {"burst/1x1024", 1, 1024},
+      {"burst/16x64", 16, 64},
+      {"burst/256x8", 256, 8},
+  };
+
+  for (const auto& burst_workload : burst_workloads) {
+    for (auto scheduler_type : scheduler_types) {
+      auto workload = BurstModel(
+          scheduler_type,
+          burst_workload.collectives_count,
+          burst_workload.burst_size,
+          events_count);
+      print_result(burst_workload.name, scheduler_type, workload.measure());
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "flow/FlowNetwork.hh"
+#include "topology/AllToAll.hh"
+
+/**
+ * Standalone benchmark of FlowNetwork rate recomputation.
+ *
+ * Workload: switch-like flows between random NPUs (an uplink of src, then
+ * a downlink of dest), keeping a fixed number of flows in flight: each
+ * flow starts a new one when it drains, until flows_count flows ran.
+ * Links of different NPUs are shared by many flows, so the flows in
+ * flight form one large connected component.
+ *
+ * Usage: AnalyticalFlowNetworkBenchmark [flows_count]
+ */
+
+namespace {
+using Analytical::AllToAll;
+using Analytical::Event;
+using Analytical::EventQueue;
+using Analytical::FlowNetwork;
+using Analytical::TopologyConfiguration;
+
+/**
+ * Flows in flight over a switch of npus_count NPUs.
+ */
+class SwitchFlows {
+ public:
+  SwitchFlows(int npus_count, uint64_t flows_count) noexcept
+      : npus_count(npus_count), flows_count(flows_count) {
+    // (AllToAll links are only used as independent links of a bandwidth)
+    auto configuration =
+        TopologyConfiguration(1, 25, 0, 0, 0, 1000000, 1, 0, 0, 1, 0);
+    auto topology = std::make_shared<AllToAll>(
+        TopologyConfiguration::TopologyConfigurations{configuration},
+        npus_count);
+    event_queue = std::make_shared<EventQueue>();
+    flow_network = std::make_shared<FlowNetwork>(event_queue, topology);
+  }
+
+  /**
+   * Run the workload.
+   * @param concurrent_flows_count number of flows in flight
+   * @return wall-clock time (in s)
+   */
+  double measure(int concurrent_flows_count) noexcept {
+    for (auto i = 0; i < concurrent_flows_count; i++) {
+      event_queue->add_event(i, Event([this]() { start_flow(); }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (!event_queue->empty()) {
+      event_queue->proceed();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+  const FlowNetwork& get_flow_network() const noexcept {
+    return *flow_network;
+  }
+
+ private:
+  void start_flow() noexcept {
+    started_flows_count++;
+    auto src = (int)(random_engine() % npus_count);
+    auto dest = (int)(random_engine() % (npus_count - 1));
+    if (dest >= src) {
+      dest++;
+    }
+    path.assign({src, npus_count + dest});
+    auto size = 10000.0 + (random_engine() % 1000000);
+    flow_network->start_flow(path, size, Event([this]() {
+                               if (started_flows_count < flows_count) {
+                                 start_flow();
+                               }
+                             }));
+  }
+
+  int npus_count;
+  uint64_t flows_count;
+  uint64_t started_flows_count = 0;
+  std::mt19937_64 random_engine{1};
+  std::vector<FlowNetwork::LinkId> path;
+  std::shared_ptr<EventQueue> event_queue;
+  std::shared_ptr<FlowNetwork> flow_network;
+};
+} // namespace
+
+int main(int argc, char* argv[]) {
+  auto flows_count = (uint64_t)20'000;
+  if (argc > 1) {
+    flows_count = std::stoull(argv[1]);
+  }
+
+  std::printf(
+      "%-8s %-10s %10s %10s %12s %12s %8s\n",
+      "NPUs",
+      "InFlight",
+      "Flows",
+      "us/flow",
+      "Rates/flow",
+      "Shares/flow",
+      "Refills");
+
+  const int concurrent_flows_counts[] = {100, 1000, 10000};
+  for (auto concurrent_flows_count : concurrent_flows_counts) {
+    auto npus_count = 4096;
+    auto workload = SwitchFlows(npus_count, flows_count);
+    auto seconds = workload.measure(concurrent_flows_count);
+    const auto& flow_network = workload.get_flow_network();
+    std::printf(
+        "%-8d %-10d %10llu %10.2f %12.2f %12.2f %8llu\n",
+        npus_count,
+        concurrent_flows_count,
+        (unsigned long long)flows_count,
+        seconds * 1e6 / flows_count,
+        (double)flow_network.get_rate_updates_count() / flows_count,
+        (double)flow_network.get_link_updates_count() / flows_count,
+        (unsigned long long)flow_network.get_refills_count());
+  }
+  return 0;
+}
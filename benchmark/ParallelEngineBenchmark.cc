@@ -0,0 +1,250 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "api/AnalyticalNetwork.hh"
+#include "topology/AllToAll.hh"
+#include "topology/Switch.hh"
+
+/**
+ * Standalone benchmark of the parallel engine, driving AnalyticalNetwork
+ * directly (without the system layer) with a synthetic exchange.
+ *
+ * Workload: in each step, every NPU sends a message to each of the next
+ * peers_count NPUs and receives one from each of the previous ones; once
+ * all of them are done, it computes for a while and starts the next step.
+ * Message sizes (1-8 KiB) and compute times (0-15 ns) vary across NPUs,
+ * so messages finish at many different times. Links have a 10 ns latency
+ * and there is no nic, router, nor HBM latency, so the lookahead is small.
+ *
+ * Each threads count runs the same workload: threads count 1 runs the
+ * sequential engine. It reports the number of windows, the simulated end
+ * time (identical for every threads count), and the wall-clock time and
+ * speedup over the sequential run.
+ *
+ * Usage: AnalyticalParallelEngineBenchmark [topology (Switch or AllToAll)]
+ *            [npus_count] [steps_count] [peers_count] [lookahead_ns]
+ *            [threads_count ...]
+ *        (defaults: Switch 1024 4 8 0 1 2 4 8 16 32;
+ *         lookahead_ns 0 keeps the lookahead computed from the topology)
+ */
+
+namespace {
+using Analytical::AnalyticalNetwork;
+using Analytical::EventQueue;
+using Analytical::ParallelEngine;
+using Analytical::Topology;
+using Analytical::TopologyConfiguration;
+
+/**
+ * An NPU running the exchange steps.
+ */
+struct Npu {
+  AnalyticalNetwork* network;
+  int npus_count;
+  int steps_count;
+  int peers_count;
+  int step = 0;
+  int pending_operations_count = 0;
+  double finish_time = 0; // (in ns)
+
+  void start_step() noexcept {
+    auto rank = network->sim_comm_get_rank();
+    pending_operations_count = 2 * peers_count;
+    for (auto peer = 1; peer <= peers_count; peer++) {
+      auto dst = (rank + peer) % npus_count;
+      auto src = (rank - peer + npus_count) % npus_count;
+      auto tag = (step * peers_count) + peer;
+      network->sim_send(
+          nullptr, message_size(rank, dst), 0, dst, tag, nullptr,
+          &Npu::on_done, this);
+      network->sim_recv(
+          nullptr, message_size(src, rank), 0, src, tag, nullptr,
+          &Npu::on_done, this);
+    }
+  }
+
+  int message_size(int src, int dst) const noexcept {
+    return 1024 * (1 + ((src + (3 * dst) + step) % 8));
+  }
+
+  static void on_done(void* npu_ptr) noexcept {
+    auto npu = static_cast<Npu*>(npu_ptr);
+    npu->pending_operations_count--;
+    if (npu->pending_operations_count > 0) {
+      return;
+    }
+
+    npu->step++;
+    if (npu->step < npu->steps_count) {
+      auto rank = npu->network->sim_comm_get_rank();
+      auto compute_time = AstraSim::timespec_t();
+      compute_time.time_res = AstraSim::NS;
+      compute_time.time_val = (rank * 7 + npu->step) % 16;
+      npu->network->sim_schedule(
+          compute_time,
+          [](void* npu_ptr) { static_cast<Npu*>(npu_ptr)->start_step(); },
+          npu);
+    } else {
+      npu->finish_time = npu->network->sim_get_time().time_val;
+    }
+  }
+};
+
+/**
+ * Result of a run.
+ */
+struct Result {
+  double seconds;
+  double end_time; // (in ns)
+  uint64_t windows_count;
+  double lookahead; // (in ns)
+};
+
+Result run(
+    const std::string& topology_name,
+    int npus_count,
+    int steps_count,
+    int peers_count,
+    double lookahead_ns,
+    int threads_count) noexcept {
+  auto configurations = TopologyConfiguration::TopologyConfigurations();
+  configurations.emplace_back(10, 25, 0, 0, 0, 1000000, 1, 0, 0, 1, 0);
+  auto create_topology = [&]() -> std::shared_ptr<Topology> {
+    if (topology_name == "AllToAll") {
+      return std::make_shared<Analytical::AllToAll>(configurations, npus_count);
+    }
+    return std::make_shared<Analytical::Switch>(configurations, npus_count);
+  };
+
+  auto event_queue = std::make_shared<EventQueue>();
+  AnalyticalNetwork::set_event_queue(event_queue);
+  AnalyticalNetwork::set_topology(create_topology());
+
+  // (set before any network exists)
+  auto parallel_engine = std::shared_ptr<ParallelEngine>();
+  if (threads_count > 1) {
+    parallel_engine = std::make_shared<ParallelEngine>(
+        npus_count,
+        threads_count,
+        EventQueue::SchedulerType::Heap,
+        create_topology);
+    if (lookahead_ns > 0) {
+      parallel_engine->set_lookahead(
+          TopologyConfiguration::nsToPs(lookahead_ns));
+    }
+  }
+  AnalyticalNetwork::set_parallel_engine(parallel_engine);
+
+  auto networks = std::vector<std::unique_ptr<AnalyticalNetwork>>();
+  auto npus = std::vector<Npu>();
+  for (auto rank = 0; rank < npus_count; rank++) {
+    networks.emplace_back(new AnalyticalNetwork(rank));
+    npus.push_back({networks.back().get(), npus_count, steps_count, peers_count});
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto& npu : npus) {
+    npu.start_step();
+  }
+  if (parallel_engine != nullptr) {
+    parallel_engine->run();
+  } else {
+    while (!event_queue->empty()) {
+      event_queue->proceed();
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  auto result = Result();
+  result.seconds = std::chrono::duration<double>(end - start).count();
+  for (const auto& npu : npus) {
+    result.end_time = std::max(result.end_time, npu.finish_time);
+  }
+  if (parallel_engine != nullptr) {
+    result.windows_count = parallel_engine->get_windows_count();
+    result.lookahead = parallel_engine->get_lookahead() / 1000.0;
+  }
+  return result;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  auto topology_name = std::string("Switch");
+  auto npus_count = 1024;
+  auto steps_count = 4;
+  auto peers_count = 8;
+  auto lookahead_ns = 0.0;
+  auto threads_counts = std::vector<int>({1, 2, 4, 8, 16, 32});
+  if (argc > 1) {
+    topology_name = argv[1];
+  }
+  if (argc > 2) {
+    npus_count = std::stoi(argv[2]);
+  }
+  if (argc > 3) {
+    steps_count = std::stoi(argv[3]);
+  }
+  if (argc > 4) {
+    peers_count = std::stoi(argv[4]);
+  }
+  if (argc > 5) {
+    lookahead_ns = std::stod(argv[5]);
+  }
+  if (argc > 6) {
+    threads_counts.clear();
+    for (auto i = 6; i < argc; i++) {
+      threads_counts.push_back(std::stoi(argv[i]));
+    }
+  }
+
+  std::printf(
+      "%s, %d NPUs, %d steps of %d peers\n",
+      topology_name.c_str(),
+      npus_count,
+      steps_count,
+      peers_count);
+  std::printf(
+      "%-8s %12s %10s %14s %10s %8s\n",
+      "Threads",
+      "Lookahead",
+      "Windows",
+      "EndTime(ns)",
+      "Wall(s)",
+      "Speedup");
+
+  auto sequential_seconds = 0.0;
+  for (auto threads_count : threads_counts) {
+    auto result = run(
+        topology_name,
+        npus_count,
+        steps_count,
+        peers_count,
+        lookahead_ns,
+        threads_count);
+    if (threads_count == 1) {
+      sequential_seconds = result.seconds;
+    }
+    std::printf(
+        "%-8d %12.1f %10llu %14.1f %10.3f",
+        threads_count,
+        result.lookahead,
+        (unsigned long long)result.windows_count,
+        result.end_time,
+        result.seconds);
+    if (sequential_seconds > 0) {
+      std::printf(" %8.2f\n", sequential_seconds / result.seconds);
+    } else {
+      // no sequential run to compare with
+      std::printf(" %8s\n", "-");
+    }
+  }
+  return 0;
+}
@@ -5,13 +5,43 @@ LICENSE file in the root directory of this source tree.
 
 #include "AnalyticalNetwork.hh"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
 std::shared_ptr<Analytical::EventQueue>
     Analytical::AnalyticalNetwork::event_queue;
 
 std::shared_ptr<Analytical::Topology> Analytical::AnalyticalNetwork::topology;
 
-Analytical::SendRecvTrackingMap
-    Analytical::AnalyticalNetwork::send_recv_tracking_map;
+std::shared_ptr<Analytical::ParallelEngine>
+    Analytical::AnalyticalNetwork::parallel_engine;
+
+std::shared_ptr<Analytical::FlowNetwork>
+    Analytical::AnalyticalNetwork::flow_network;
+
+std::vector<Analytical::AnalyticalNetwork*>
+    Analytical::AnalyticalNetwork::networks;
+
+Analytical::AnalyticalNetwork::AnalyticalNetwork(int rank) noexcept
+    : AstraSim::AstraNetworkAPI(rank) {
+  if ((int)networks.size() <= rank) {
+    networks.resize(rank + 1, nullptr);
+  }
+  networks[rank] = this;
+
+  if (parallel_engine != nullptr) {
+    parallel_engine->get_partition(rank).set_send_recv_tracking_map(
+        rank, &send_recv_tracking_map);
+  }
+}
+
+Analytical::AnalyticalNetwork::~AnalyticalNetwork() noexcept {
+  networks[rank] = nullptr;
+}
 
 void Analytical::AnalyticalNetwork::set_event_queue(
     const std::shared_ptr<EventQueue>& event_queue_ptr) noexcept {
@@ -23,6 +53,157 @@ void Analytical::AnalyticalNetwork::set_topology(
   AnalyticalNetwork::topology = topology_ptr;
 }
 
+void Analytical::AnalyticalNetwork::set_parallel_engine(
+    const std::shared_ptr<ParallelEngine>& parallel_engine_ptr) noexcept {
+  AnalyticalNetwork::parallel_engine = parallel_engine_ptr;
+
+  // let each partition match deliveries into its npus' tracking maps
+  for (const auto network : networks) {
+    if (network != nullptr) {
+      parallel_engine->get_partition(network->rank)
+          .set_send_recv_tracking_map(
+              network->rank, &network->send_recv_tracking_map);
+    }
+  }
+}
+
+void Analytical::AnalyticalNetwork::set_flow_network(
+    const std::shared_ptr<FlowNetwork>& flow_network_ptr) noexcept {
+  AnalyticalNetwork::flow_network = flow_network_ptr;
+}
+
+void Analytical::AnalyticalNetwork::print_send_recv_tracking_map() noexcept {
+  auto entries_count = (size_t)0;
+  auto memory_usage = (size_t)0;
+  auto peak_memory_usage = (size_t)0;
+  for (const auto network : networks) {
+    if (network != nullptr) {
+      const auto& tracking_map = network->send_recv_tracking_map;
+      entries_count += tracking_map.size();
+      memory_usage += tracking_map.get_memory_usage();
+      peak_memory_usage += tracking_map.get_peak_memory_usage();
+    }
+  }
+
+  std::cout << "[SendRecvTrackingMap] Entries not processed: " << entries_count
+            << " (memory: " << memory_usage / 1024
+            << " KiB, sum of per-npu peak memory: " << peak_memory_usage / 1024
+            << " KiB)" << std::endl;
+}
+
+void Analytical::AnalyticalNetwork::print_wait_histograms() noexcept {
+  auto late_sender_histogram = WaitHistogram();
+  auto late_receiver_histogram = WaitHistogram();
+  auto output = std::ostringstream();
+
+  for (const auto network : networks) {
+    if (network == nullptr) {
+      continue;
+    }
+    const auto& tracking_map = network->send_recv_tracking_map;
+    late_sender_histogram.merge(tracking_map.get_late_sender_histogram());
+    late_receiver_histogram.merge(tracking_map.get_late_receiver_histogram());
+
+    output << "[WaitHistogram] NPU " << network->rank << " late sender: ";
+    tracking_map.get_late_sender_histogram().print_summary(output);
+    output << std::endl;
+    output << "[WaitHistogram] NPU " << network->rank << " late receiver: ";
+    tracking_map.get_late_receiver_histogram().print_summary(output);
+    output << std::endl;
+  }
+
+  late_sender_histogram.print("[WaitHistogram] Late sender (all NPUs)", output);
+  late_receiver_histogram.print(
+      "[WaitHistogram] Late receiver (all NPUs)", output);
+  std::cout << output.str();
+}
+
+Analytical::EventQueue& Analytical::AnalyticalNetwork::
+    get_event_queue() noexcept {
+  if (parallel_engine == nullptr) {
+    return *event_queue;
+  }
+  return parallel_engine->get_partition(sim_comm_get_rank()).get_event_queue();
+}
+
+Analytical::EventKey Analytical::AnalyticalNetwork::next_event_key() noexcept {
+  return {get_current_time(), sim_comm_get_rank(), issued_events_count++};
+}
+
+Analytical::Topology& Analytical::AnalyticalNetwork::get_topology() noexcept {
+  if (parallel_engine == nullptr) {
+    return *topology;
+  }
+  return parallel_engine->get_partition(sim_comm_get_rank()).get_topology();
+}
+
+Analytical::SendRecvWatchdog::SendRecvTrackingMaps Analytical::
+    AnalyticalNetwork::get_send_recv_tracking_maps() noexcept {
+  auto maps = SendRecvWatchdog::SendRecvTrackingMaps();
+  for (const auto network : networks) {
+    if (network != nullptr) {
+      maps.push_back(&network->send_recv_tracking_map);
+    }
+  }
+  return maps;
+}
+
+Analytical::SendRecvTrackingMap& Analytical::AnalyticalNetwork::
+    get_send_recv_tracking_map(int npu_id) noexcept {
+  assert(
+      npu_id >= 0 && npu_id < (int)networks.size() &&
+      networks[npu_id] != nullptr &&
+      "<AnalyticalNetwork::get_send_recv_tracking_map> no network for npu");
+  return networks[npu_id]->send_recv_tracking_map;
+}
+
+Analytical::TimeStamp Analytical::AnalyticalNetwork::
+    get_current_time() noexcept {
+  if (parallel_engine != nullptr) {
+    // the system layer may read time through another npu's network:
+    // always report the time of the partition running on this thread
+    auto running_partition = ParallelEngine::get_running_partition();
+    if (running_partition != nullptr) {
+      return running_partition->get_event_queue().get_current_time();
+    }
+  }
+
+  return get_event_queue().get_current_time();
+}
+
+Analytical::TimeStamp Analytical::AnalyticalNetwork::to_time_stamp(
+    AstraSim::timespec_t time) noexcept {
+  // number of ps in one time_res unit
+  auto scale = 1.0;
+  switch (time.time_res) {
+    case AstraSim::SE:
+      scale = 1e12;
+      break;
+    case AstraSim::MS:
+      scale = 1e9;
+      break;
+    case AstraSim::US:
+      scale = 1e6;
+      break;
+    case AstraSim::NS:
+      scale = 1e3;
+      break;
+    case AstraSim::FS:
+      scale = 1e-3;
+      break;
+  }
+
+  return (TimeStamp)std::llround(time.time_val * scale);
+}
+
+AstraSim::timespec_t Analytical::AnalyticalNetwork::to_timespec(
+    TimeStamp time_stamp) noexcept {
+  AstraSim::timespec_t time;
+  time.time_res = AstraSim::NS;
+  time.time_val = time_stamp / 1000.0;
+  return time;
+}
+
 int Analytical::AnalyticalNetwork::sim_comm_size(
     AstraSim::sim_comm comm,
     int* size) {
@@ -34,7 +215,8 @@ int Analytical::AnalyticalNetwork::sim_finish() {
 }
 
 double Analytical::AnalyticalNetwork::sim_time_resolution() {
-  return 0;
+  // simulated time is tracked in ps, and reported in ns
+  return 0.001;
 }
 
 int Analytical::AnalyticalNetwork::sim_init(AstraSim::AstraMemoryAPI* MEM) {
@@ -42,7 +224,7 @@ int Analytical::AnalyticalNetwork::sim_init(AstraSim::AstraMemoryAPI* MEM) {
 }
 
 AstraSim::timespec_t Analytical::AnalyticalNetwork::sim_get_time() {
-  return event_queue->get_current_time();
+  return to_timespec(get_current_time());
 }
 
 void Analytical::AnalyticalNetwork::sim_schedule(
@@ -50,13 +232,11 @@ void Analytical::AnalyticalNetwork::sim_schedule(
     void (*fun_ptr)(void*),
     void* fun_arg) {
   // 1. compute event_time = current_time + delta
-  auto event_time = sim_get_time();
-
-  // FIXME: assuming time_res is always NS
-  event_time.time_val += delta.time_val;
+  auto event_time = get_current_time() + to_time_stamp(delta);
 
   // 2. schedule an event at the event_time
-  event_queue->add_event(event_time, fun_ptr, fun_arg);
+  get_event_queue().add_event(
+      event_time, Event(fun_ptr, fun_arg), next_event_key());
 }
 
 int Analytical::AnalyticalNetwork::sim_send(
@@ -71,42 +251,123 @@ int Analytical::AnalyticalNetwork::sim_send(
   // get source id
   auto src = sim_comm_get_rank();
 
-  // compute send latency in ns    // FIXME: if you want to use time_res other
-  // than NS
-  AstraSim::timespec_t delta;
-  delta.time_res = AstraSim::NS;
-  delta.time_val =
-      (int)topology->send(src, dst, count); // simulate src->dst and get latency
-
-  if (send_recv_tracking_map.has_recv_operation(tag, src, dst, count)) {
-    // recv operation already issued.
-    // Schedule both send and recv event handler.
-    auto recv_event_handler =
-        send_recv_tracking_map.pop_recv_event_handler(tag, src, dst, count);
-    sim_schedule(delta, msg_handler, fun_arg);
-    sim_schedule(
-        delta,
-        recv_event_handler.get_fun_ptr(),
-        recv_event_handler.get_fun_arg());
-  } else {
-    // recv operation not issued yet.
-    // Should assign this send operation to the tracker.
+  // simulate src->dst and get latency (in ps)
+  auto current_time = get_current_time();
+  auto& topology = get_topology();
+  topology.setCurrentTime(current_time);
+  auto latency = topology.send(src, dst, count);
+  auto send_key = next_event_key();
 
-    // schedule send event
-    sim_schedule(delta, msg_handler, fun_arg);
+  if (flow_network != nullptr && src != dst) {
+    // the send finishes once its flow has drained
+    start_flow_send(
+        {dst, tag, count, current_time, 0, send_key, msg_handler, fun_arg},
+        latency);
+    return 0;
+  }
 
-    // compute send finish time  // FIXME: if you want to use time_res other
-    // than NS
-    auto send_finish_time = sim_get_time();
-    send_finish_time.time_val += delta.time_val;
+  // compute send finish time
+  auto send_finish_time = current_time + latency;
 
-    // schedule this into the tracker
-    send_recv_tracking_map.insert_send(tag, src, dst, count, send_finish_time);
+  if (parallel_engine != nullptr &&
+      !parallel_engine->is_same_partition(src, dst)) {
+    // dst is simulated by another partition.
+    // schedule send event, and post the send operation to dst's partition
+    get_event_queue().add_event(
+        send_finish_time, Event(msg_handler, fun_arg), send_key);
+    parallel_engine->deliver(
+        {tag, src, dst, count, current_time, send_finish_time, send_key});
+    return 0;
   }
 
+  finish_send(
+      dst,
+      tag,
+      count,
+      current_time,
+      send_finish_time,
+      send_key,
+      msg_handler,
+      fun_arg);
   return 0;
 }
 
+void Analytical::AnalyticalNetwork::start_flow_send(
+    const FlowSend& flow_send,
+    TimeStamp latency) noexcept {
+  auto index = (uint32_t)flow_sends.size();
+  if (free_flow_sends.empty()) {
+    flow_sends.push_back(flow_send);
+  } else {
+    index = free_flow_sends.back();
+    free_flow_sends.pop_back();
+    flow_sends[index] = flow_send;
+  }
+
+  auto wire_size = get_topology().takePath(flow_path);
+  auto transfer_time = flow_network->start_flow(
+      flow_path, wire_size, Event([this, index]() {
+        finish_flow_send(index);
+      }));
+
+  // latency already counts the transfer at full bandwidth:
+  // the rest of it is left once the flow has drained
+  flow_sends[index].tail_latency =
+      latency - std::min(latency, transfer_time);
+}
+
+void Analytical::AnalyticalNetwork::finish_flow_send(uint32_t index) noexcept {
+  auto flow_send = flow_sends[index];
+  free_flow_sends.push_back(index);
+
+  auto send_finish_time = get_current_time() + flow_send.tail_latency;
+  finish_send(
+      flow_send.dst,
+      flow_send.tag,
+      flow_send.count,
+      flow_send.post_time,
+      send_finish_time,
+      flow_send.send_key,
+      flow_send.msg_handler,
+      flow_send.fun_arg);
+}
+
+void Analytical::AnalyticalNetwork::finish_send(
+    int dst,
+    int tag,
+    int count,
+    TimeStamp post_time,
+    TimeStamp send_finish_time,
+    const EventKey& send_key,
+    void (*msg_handler)(void* fun_arg),
+    void* fun_arg) noexcept {
+  auto& event_queue = get_event_queue();
+
+  // schedule send event
+  event_queue.add_event(
+      send_finish_time, Event(msg_handler, fun_arg), send_key);
+
+  // match the recv operation if already issued.
+  // Otherwise, this send operation is assigned to the tracker.
+  auto recv_event_handler = Event();
+  auto recv_key = EventKey();
+  if (get_send_recv_tracking_map(dst).match_or_insert_send(
+          tag,
+          sim_comm_get_rank(),
+          dst,
+          count,
+          post_time,
+          send_finish_time,
+          send_key,
+          recv_event_handler,
+          recv_key)) {
+    // recv operation already issued: schedule recv event handler,
+    // keyed by the later of the two operations
+    event_queue.add_event(
+        send_finish_time, recv_event_handler, std::max(send_key, recv_key));
+  }
+}
+
 int Analytical::AnalyticalNetwork::sim_recv(
     void* buffer,
     int count,
@@ -119,35 +380,48 @@ int Analytical::AnalyticalNetwork::sim_recv(
   // get source id
   auto dst = sim_comm_get_rank();
 
-  if (send_recv_tracking_map.has_send_operation(tag, src, dst, count)) {
-    // send operation already issued.
-    // should compute delta
-    AstraSim::timespec_t delta;
-    delta.time_res = AstraSim::NS;
-
-    auto current_time = sim_get_time();
-    auto send_finish_time =
-        send_recv_tracking_map.pop_send_finish_time(tag, src, dst, count);
+  if (parallel_engine != nullptr &&
+      (src == SendRecvTrackingMap::any_source ||
+       (tag == SendRecvTrackingMap::any_tag &&
+        !parallel_engine->is_same_partition(src, dst)))) {
+    // sends from other partitions are only matched at window boundaries
+    std::cout << "[AnalyticalNetwork] Wildcard recv (npu " << dst
+              << ") accepting sends from other partitions requires "
+                 "threads-count 1"
+              << std::endl;
+    exit(-1);
+  }
 
-    if (EventQueueEntry::compare_time_stamp(current_time, send_finish_time) <
-        0) {
+  // match the send operation if already issued.
+  // Otherwise, add recv to the tracker and wait until corresponding sim_send
+  // to be invoked.
+  auto current_time = get_current_time();
+  auto recv_key = next_event_key();
+  auto send_finish_time = TimeStamp(0);
+  auto send_key = EventKey();
+  if (send_recv_tracking_map.match_or_insert_recv(
+          tag,
+          src,
+          dst,
+          count,
+          current_time,
+          Event(msg_handler, fun_arg),
+          recv_key,
+          send_finish_time,
+          send_key)) {
+    // send operation already issued: keyed by the later of the two
+    auto key = std::max(send_key, recv_key);
+    if (current_time < send_finish_time) {
       // sent packet still inflight
       // schedule recv handler accordingly.
-      delta.time_val = send_finish_time.time_val - current_time.time_val;
+      get_event_queue().add_event(
+          send_finish_time, Event(msg_handler, fun_arg), key);
     } else {
       // send operation already finished.
       // invoke recv handler immediately
-      delta.time_val = 0;
+      get_event_queue().add_event(
+          current_time, Event(msg_handler, fun_arg), key);
     }
-
-    // schedule recv handler
-    sim_schedule(delta, msg_handler, fun_arg);
-  } else {
-    // send operation not issued.
-    // Add recv to the tracker and wait until corresponding sim_send to be
-    // invoked.
-    send_recv_tracking_map.insert_recv(
-        tag, src, dst, count, msg_handler, fun_arg);
   }
 
   return 0;
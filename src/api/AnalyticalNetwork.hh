@@ -7,9 +7,15 @@ LICENSE file in the root directory of this source tree.
 #define __ANALYTICALNETWORK_HH__
 
 #include <memory>
+#include <vector>
+#include "../event-queue/EventKey.hh"
 #include "../event-queue/EventQueue.hh"
+#include "../event-queue/TimeStamp.hh"
+#include "../flow/FlowNetwork.hh"
+#include "../parallel/ParallelEngine.hh"
 #include "../topology/Topology.hh"
 #include "SendRecvTrackingMap.hh"
+#include "SendRecvWatchdog.hh"
 #include "astra-sim/system/AstraNetworkAPI.hh"
 
 namespace Analytical {
@@ -29,11 +35,52 @@ class AnalyticalNetwork : public AstraSim::AstraNetworkAPI {
   static void set_topology(
       const std::shared_ptr<Topology>& topology_ptr) noexcept;
 
+  /**
+   * set parallel_engine to the given pointer.
+   * Once set, each network uses the event_queue and topology of its
+   * partition instead of the shared ones, and sends to another partition
+   * are matched into the destination's send_recv_tracking_map by the
+   * destination's partition.
+   * @param parallel_engine_ptr pointer to the parallel engine
+   */
+  static void set_parallel_engine(
+      const std::shared_ptr<ParallelEngine>& parallel_engine_ptr) noexcept;
+
+  /**
+   * set flow_network to the given pointer.
+   * Once set, the payload of each send is a flow of the flow network, and
+   * the send finishes once the flow has drained (plus the rest of the
+   * latency reported by the topology).
+   * @param flow_network_ptr pointer to the flow network
+   */
+  static void set_flow_network(
+      const std::shared_ptr<FlowNetwork>& flow_network_ptr) noexcept;
+
+  /**
+   * Print the status (pending operations and memory usage)
+   * of the send/recv tracking maps of all networks.
+   */
+  static void print_send_recv_tracking_map() noexcept;
+
+  /**
+   * Print the late sender and late receiver wait histograms
+   * of every npu, then of all npus together.
+   */
+  static void print_wait_histograms() noexcept;
+
+  /**
+   * @return send/recv tracking maps of all networks
+   */
+  static SendRecvWatchdog::SendRecvTrackingMaps
+  get_send_recv_tracking_maps() noexcept;
+
   /**
    * ========================= AstraNetworkAPIs
    * =================================================
    */
-  explicit AnalyticalNetwork(int rank) : AstraSim::AstraNetworkAPI(rank) {}
+  explicit AnalyticalNetwork(int rank) noexcept;
+
+  ~AnalyticalNetwork() noexcept;
 
   int sim_comm_size(AstraSim::sim_comm comm, int* size) override;
 
@@ -60,6 +107,14 @@ class AnalyticalNetwork : public AstraSim::AstraNetworkAPI {
       void (*msg_handler)(void* fun_arg),
       void* fun_arg) override;
 
+  /**
+   * src may be SendRecvTrackingMap::any_source and tag may be
+   * SendRecvTrackingMap::any_tag: the recv then matches the first arriving
+   * send operation it accepts.
+   * Under the parallel engine, a wildcard recv that may accept a send from
+   * another partition exits with an error: such sends only arrive at window
+   * boundaries, so it could match another send than the sequential run.
+   */
   int sim_recv(
       void* buffer,
       int count,
@@ -76,7 +131,131 @@ class AnalyticalNetwork : public AstraSim::AstraNetworkAPI {
  private:
   static std::shared_ptr<EventQueue> event_queue;
   static std::shared_ptr<Topology> topology;
-  static SendRecvTrackingMap send_recv_tracking_map;
+  static std::shared_ptr<ParallelEngine> parallel_engine;
+  static std::shared_ptr<FlowNetwork> flow_network;
+
+  /**
+   * networks[rank]: network of rank (nullptr if not constructed)
+   */
+  static std::vector<AnalyticalNetwork*> networks;
+
+  /**
+   * Inbound send/recv tracking map: operations destined to this npu.
+   * Sharding by destination keeps each npu's pending operations together,
+   * and lets each partition match its own npus' operations.
+   */
+  SendRecvTrackingMap send_recv_tracking_map;
+
+  /**
+   * number of events issued by this npu
+   * (sequence of their keys)
+   */
+  uint32_t issued_events_count = 0;
+
+  /**
+   * Send operation whose flow is in flight in the flow network.
+   */
+  struct FlowSend {
+    int dst;
+    int tag;
+    int count;
+    TimeStamp post_time; // time the send operation is posted
+    TimeStamp tail_latency; // latency left once the flow has drained
+    EventKey send_key; // key of the events issued by the send operation
+    void (*msg_handler)(void* fun_arg);
+    void* fun_arg;
+  };
+
+  /**
+   * pool of flow sends of this npu, and indices of the free ones
+   */
+  std::vector<FlowSend> flow_sends;
+  std::vector<uint32_t> free_flow_sends;
+
+  /**
+   * links passed by the flow being started
+   */
+  std::vector<Topology::LinkId> flow_path;
+
+  /**
+   * Start the flow of a send operation.
+   * @param flow_send send operation
+   * @param latency latency of the send reported by the topology
+   */
+  void start_flow_send(const FlowSend& flow_send, TimeStamp latency) noexcept;
+
+  /**
+   * Finish a send operation once its flow has drained.
+   * @param index index of the flow send
+   */
+  void finish_flow_send(uint32_t index) noexcept;
+
+  /**
+   * Schedule the send event of a send operation, and match its recv
+   * operation if already issued (otherwise, track the send operation).
+   * (Sequential, or dst in the same partition)
+   * @param dst
+   * @param tag
+   * @param count
+   * @param post_time time the send operation is posted
+   * @param send_finish_time
+   * @param send_key key of the events issued by the send operation
+   * @param msg_handler
+   * @param fun_arg
+   */
+  void finish_send(
+      int dst,
+      int tag,
+      int count,
+      TimeStamp post_time,
+      TimeStamp send_finish_time,
+      const EventKey& send_key,
+      void (*msg_handler)(void* fun_arg),
+      void* fun_arg) noexcept;
+
+  /**
+   * Convert AstraSim time of any time_res into ps.
+   * @param time time to convert
+   * @return time in ps
+   */
+  static TimeStamp to_time_stamp(AstraSim::timespec_t time) noexcept;
+
+  /**
+   * Convert ps into AstraSim time, in ns.
+   * @param time_stamp time in ps
+   * @return time in ns
+   */
+  static AstraSim::timespec_t to_timespec(TimeStamp time_stamp) noexcept;
+
+  /**
+   * @return current simulated time (in ps) seen by this npu
+   */
+  TimeStamp get_current_time() noexcept;
+
+  /**
+   * Key the next event issued by this npu:
+   * (current_time, rank, number of events issued so far).
+   * Events sharing a time stamp then run in the same order
+   * with any number of threads.
+   * @return key of the event
+   */
+  EventKey next_event_key() noexcept;
+
+  /**
+   * @return event_queue this npu schedules events into
+   */
+  EventQueue& get_event_queue() noexcept;
+
+  /**
+   * @return topology this npu sends packets through
+   */
+  Topology& get_topology() noexcept;
+
+  /**
+   * @param npu_id
+   * @return send_recv_tracking_map holding operations destined to npu_id
+   */
+  static SendRecvTrackingMap& get_send_recv_tracking_map(int npu_id) noexcept;
 };
 } // namespace Analytical
 
@@ -5,121 +5,477 @@ LICENSE file in the root directory of this source tree.
 
 #include "SendRecvTrackingMap.hh"
 
+#include <algorithm>
 #include <cassert>
+#include <iostream>
+#include <limits>
 
-bool Analytical::SendRecvTrackingMap::has_send_operation(
+Analytical::SendRecvTrackingMap::SendRecvTrackingMap() noexcept
+    : slots(initial_capacity) {
+  update_peak_memory_usage();
+}
+
+bool Analytical::SendRecvTrackingMap::match_or_insert_send(
     int tag,
     int src,
     int dest,
-    int count) const noexcept {
-  auto search_result =
-      send_recv_tracking_map.find(std::make_tuple(tag, src, dest, count));
+    int count,
+    TimeStamp post_time,
+    TimeStamp send_finish_time,
+    const EventKey& send_key,
+    Event& recv_event,
+    EventKey& recv_key) noexcept {
+  assert(
+      tag != any_tag && src != any_source &&
+      "<SendRecvTrackingMap::match_or_insert_send> wildcard send operation");
 
-  if (search_result == send_recv_tracking_map.end()) {
-    // no matching entry found
+  auto key = make_key(tag, src, dest, count);
+  auto slot = find_recv(key);
+
+  if (slot == slots.size()) {
+    // no matching recv operation: track this send operation
+    push_back(
+        key,
+        SendRecvTrackingMapValue::make_send_value(
+            post_time, send_finish_time, send_key));
     return false;
   }
 
-  // check if the found entry is send operation
-  return search_result->second.is_send();
+  // matching recv operation found: pop it
+  if (!(slots[slot].key == key)) {
+    wildcard_recvs_count--;
+  }
+  auto recv_value = pop_front(slot);
+  recv_event = recv_value.get_recv_event();
+  recv_key = recv_value.get_event_key();
+  record_waits(post_time, send_finish_time, recv_value.get_post_time());
+  return true;
 }
 
-bool Analytical::SendRecvTrackingMap::has_recv_operation(
+bool Analytical::SendRecvTrackingMap::match_or_insert_recv(
     int tag,
     int src,
     int dest,
-    int count) const noexcept {
-  auto search_result =
-      send_recv_tracking_map.find(std::make_tuple(tag, src, dest, count));
+    int count,
+    TimeStamp post_time,
+    const Event& recv_event,
+    const EventKey& recv_key,
+    TimeStamp& send_finish_time,
+    EventKey& send_key) noexcept {
+  auto key = make_key(tag, src, dest, count);
+  auto recv_value = SendRecvTrackingMapValue::make_recv_value(
+      post_time, recv_event, recv_key, posted_recvs_count++);
 
-  if (search_result == send_recv_tracking_map.end()) {
-    // no matching entry found
+  if (tag == any_tag || src == any_source) {
+    // wildcard recv operation: match the first arrived send operation
+    enable_wildcard_indices();
+
+    auto wildcard_send_key = Key();
+    if (!find_wildcard_send(tag, src, dest, count, wildcard_send_key)) {
+      push_back(key, recv_value);
+      wildcard_recvs_count++;
+      return false;
+    }
+
+    auto send_value = pop_front(find(wildcard_send_key));
+    send_finish_time = send_value.get_send_finish_time();
+    send_key = send_value.get_event_key();
+    record_waits(send_value.get_post_time(), send_finish_time, post_time);
+    return true;
+  }
+
+  auto slot = find(key);
+  if (!slots[slot].occupied || slots[slot].value.is_recv()) {
+    // no matching send operation: track this recv operation
+    push_back(key, recv_value);
     return false;
   }
 
-  // check if the found entry is recv operation
-  return search_result->second.is_recv();
+  // matching send operation found: pop the oldest one
+  auto send_value = pop_front(slot);
+  send_finish_time = send_value.get_send_finish_time();
+  send_key = send_value.get_event_key();
+  record_waits(send_value.get_post_time(), send_finish_time, post_time);
+  return true;
 }
 
-AstraSim::timespec_t Analytical::SendRecvTrackingMap::pop_send_finish_time(
-    int tag,
-    int src,
-    int dest,
-    int count) noexcept {
-  assert(
-      has_send_operation(tag, src, dest, count) &&
-      "<SendRecvTrackingMap::pop_send_finish_time> no matching entry");
+const Analytical::WaitHistogram& Analytical::SendRecvTrackingMap::
+    get_late_sender_histogram() const noexcept {
+  return late_sender_histogram;
+}
+
+const Analytical::WaitHistogram& Analytical::SendRecvTrackingMap::
+    get_late_receiver_histogram() const noexcept {
+  return late_receiver_histogram;
+}
+
+void Analytical::SendRecvTrackingMap::record_waits(
+    TimeStamp send_post_time,
+    TimeStamp send_finish_time,
+    TimeStamp recv_post_time) noexcept {
+  late_sender_histogram.record(
+      (send_post_time > recv_post_time) ? send_post_time - recv_post_time : 0);
+  late_receiver_histogram.record(
+      (recv_post_time > send_finish_time) ? recv_post_time - send_finish_time
+                                          : 0);
+}
+
+size_t Analytical::SendRecvTrackingMap::size() const noexcept {
+  return entries_count;
+}
+
+Analytical::TimeStamp Analytical::SendRecvTrackingMap::get_oldest_post_time()
+    const noexcept {
+  // operations of a key are queued in posting order:
+  // the oldest operation of each key is stored in its slot
+  auto oldest_post_time = std::numeric_limits<TimeStamp>::max();
+  for (const auto& entry : slots) {
+    if (entry.occupied) {
+      oldest_post_time =
+          std::min(oldest_post_time, entry.value.get_post_time());
+    }
+  }
+  return oldest_post_time;
+}
+
+void Analytical::SendRecvTrackingMap::get_pending_operations(
+    std::vector<PendingOperation>& pending_operations) const noexcept {
+  for (const auto& entry : slots) {
+    if (!entry.occupied) {
+      continue;
+    }
 
-  auto send_entry =
-      send_recv_tracking_map.find(std::make_tuple(tag, src, dest, count));
+    int tag, src, dest, count;
+    std::tie(tag, src, dest, count) = unpack_key(entry.key);
+    auto is_send = entry.value.is_send();
+    pending_operations.push_back(
+        {is_send, tag, src, dest, count, entry.value.get_post_time()});
 
-  // move sim_finish_time
-  auto sim_finish_time = std::move(send_entry->second.get_send_finish_time());
+    auto node = entry.queue_head;
+    for (uint32_t i = 0; i < entry.queued_count; i++) {
+      pending_operations.push_back(
+          {is_send, tag, src, dest, count, nodes[node].value.get_post_time()});
+      node = nodes[node].next;
+    }
+  }
+}
 
-  // pop entry
-  send_recv_tracking_map.erase(send_entry);
+size_t Analytical::SendRecvTrackingMap::get_memory_usage() const noexcept {
+  // wildcard indices: approximate red-black tree node size
+  // (entry, 3 pointers and color)
+  auto tree_node_overhead = 4 * sizeof(void*);
+  auto wildcard_indices_memory_usage =
+      ((any_source_index.size() + any_tag_index.size()) *
+       (sizeof(WildcardIndexEntry) + tree_node_overhead)) +
+      (any_source_tag_index.size() *
+       (sizeof(AnyIndexEntry) + tree_node_overhead));
 
-  // return saved
-  return sim_finish_time;
+  return (slots.capacity() * sizeof(Slot)) +
+      (nodes.capacity() * sizeof(Node)) + wildcard_indices_memory_usage;
 }
 
-Analytical::Event Analytical::SendRecvTrackingMap::pop_recv_event_handler(
+size_t Analytical::SendRecvTrackingMap::get_peak_memory_usage()
+    const noexcept {
+  return peak_memory_usage;
+}
+
+Analytical::SendRecvTrackingMap::Key Analytical::SendRecvTrackingMap::make_key(
     int tag,
     int src,
     int dest,
     int count) noexcept {
-  assert(
-      has_recv_operation(tag, src, dest, count) &&
-      "<SendRecvTrackingMap::pop_recv_event_handler> no matching entry");
+  return {
+      ((uint64_t)(uint32_t)tag << 32) | (uint32_t)src,
+      ((uint64_t)(uint32_t)dest << 32) | (uint32_t)count};
+}
 
-  auto recv_entry =
-      send_recv_tracking_map.find(std::make_tuple(tag, src, dest, count));
+std::tuple<int, int, int, int> Analytical::SendRecvTrackingMap::unpack_key(
+    const Key& key) noexcept {
+  return std::make_tuple(
+      (int)(uint32_t)(key.tag_src >> 32),
+      (int)(uint32_t)key.tag_src,
+      (int)(uint32_t)(key.dest_count >> 32),
+      (int)(uint32_t)key.dest_count);
+}
 
-  // move event handler
-  auto event = std::move(recv_entry->second.get_recv_event());
+size_t Analytical::SendRecvTrackingMap::home_slot(
+    const Key& key) const noexcept {
+  // fold both halves, then apply splitmix64 finalizer
+  auto hash = key.tag_src ^ (key.dest_count * 0x9e3779b97f4a7c15ULL);
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
 
-  // pop entry
-  send_recv_tracking_map.erase(recv_entry);
+  return hash & (slots.size() - 1);
+}
 
-  // return saved
-  return event;
+size_t Analytical::SendRecvTrackingMap::find(const Key& key) const noexcept {
+  auto mask = slots.size() - 1;
+  auto slot = home_slot(key);
+  while (slots[slot].occupied && !(slots[slot].key == key)) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
 }
 
-void Analytical::SendRecvTrackingMap::insert_send(
-    int tag,
-    int src,
-    int dest,
-    int count,
-    AstraSim::timespec_t send_finish_time) noexcept {
-  // Check whether entry with the same key exists
-  assert(
-      (send_recv_tracking_map.find(std::make_tuple(tag, src, dest, count)) ==
-       send_recv_tracking_map.end()) &&
-      "<SendRecvTrackingMap::insert_send> Same key entry already exist.");
+void Analytical::SendRecvTrackingMap::push_back(
+    const Key& key,
+    const SendRecvTrackingMapValue& value) noexcept {
+  // keep load factor below 1/2 even if key gets inserted
+  if (((occupied_slots_count + 1) * 2) > slots.size()) {
+    grow();
+  }
+
+  auto& entry = slots[find(key)];
+  if (!entry.occupied) {
+    // no pending operation with this key
+    entry.occupied = true;
+    entry.queued_count = 0;
+    entry.key = key;
+    entry.value = value;
+    occupied_slots_count++;
+
+    if (wildcard_indices_enabled && value.is_send()) {
+      wildcard_indices_insert(key, value.get_send_finish_time());
+    }
+  } else {
+    // operations of the same type are pending: queue after them
+    assert(
+        entry.value.is_send() == value.is_send() &&
+        "<SendRecvTrackingMap::push_back> matching operation is pending");
+
+    auto node = acquire_node(value);
+    if (entry.queued_count == 0) {
+      entry.queue_head = node;
+    } else {
+      nodes[entry.queue_tail].next = node;
+    }
+    entry.queue_tail = node;
+    entry.queued_count++;
+  }
+
+  entries_count++;
+  peak_entries_count = std::max(peak_entries_count, entries_count);
+}
+
+Analytical::SendRecvTrackingMapValue Analytical::SendRecvTrackingMap::
+    pop_front(size_t slot) noexcept {
+  auto& entry = slots[slot];
+  assert(entry.occupied && "<SendRecvTrackingMap::pop_front> empty slot");
+
+  auto value = entry.value;
+  entries_count--;
 
-  send_recv_tracking_map.emplace(
-      std::make_tuple(tag, src, dest, count),
-      SendRecvTrackingMapValue::make_send_value(send_finish_time));
+  auto is_indexed_send = wildcard_indices_enabled && value.is_send();
+  if (is_indexed_send) {
+    wildcard_indices_erase(entry.key, value.get_send_finish_time());
+  }
+
+  if (entry.queued_count == 0) {
+    erase(slot);
+    return value;
+  }
+
+  // the next queued operation becomes the oldest one
+  auto node = entry.queue_head;
+  entry.value = nodes[node].value;
+  entry.queue_head = nodes[node].next;
+  entry.queued_count--;
+  release_node(node);
+
+  if (is_indexed_send) {
+    wildcard_indices_insert(entry.key, entry.value.get_send_finish_time());
+  }
+
+  return value;
 }
 
-void Analytical::SendRecvTrackingMap::insert_recv(
+size_t Analytical::SendRecvTrackingMap::find_recv(
+    const Key& key) const noexcept {
+  auto slot = find(key);
+  if (slots[slot].occupied && slots[slot].value.is_send()) {
+    // send operations with the same key are pending:
+    // no recv operation accepted them
+    return slots.size();
+  }
+
+  auto matched_slot = slots[slot].occupied ? slot : slots.size();
+  if (wildcard_recvs_count == 0) {
+    return matched_slot;
+  }
+
+  // earliest posted recv operation among the exact and wildcard ones
+  int tag, src, dest, count;
+  std::tie(tag, src, dest, count) = unpack_key(key);
+  const Key wildcard_keys[] = {
+      make_key(tag, any_source, dest, count),
+      make_key(any_tag, src, dest, count),
+      make_key(any_tag, any_source, dest, count)};
+
+  for (const auto& wildcard_key : wildcard_keys) {
+    auto wildcard_slot = find(wildcard_key);
+    if (!slots[wildcard_slot].occupied) {
+      continue;
+    }
+    if ((matched_slot == slots.size()) ||
+        (slots[wildcard_slot].value.get_sequence_number() <
+         slots[matched_slot].value.get_sequence_number())) {
+      matched_slot = wildcard_slot;
+    }
+  }
+  return matched_slot;
+}
+
+bool Analytical::SendRecvTrackingMap::find_wildcard_send(
     int tag,
     int src,
     int dest,
     int count,
-    void (*fun_ptr)(void*),
-    void* fun_arg) noexcept {
-  assert(
-      (send_recv_tracking_map.find(std::make_tuple(tag, src, dest, count)) ==
-       send_recv_tracking_map.end()) &&
-      "<SendRecvTrackingMap::insert_recv> Same key entry already exist.");
+    Key& key) const noexcept {
+  constexpr auto min_int = std::numeric_limits<int>::min();
+
+  if (tag == any_tag && src == any_source) {
+    auto it = any_source_tag_index.lower_bound(
+        std::make_tuple(dest, count, (TimeStamp)0, min_int, min_int));
+    if (it == any_source_tag_index.end() || std::get<0>(*it) != dest ||
+        std::get<1>(*it) != count) {
+      return false;
+    }
+    key = make_key(std::get<3>(*it), std::get<4>(*it), dest, count);
+    return true;
+  }
+
+  if (src == any_source) {
+    auto it = any_source_index.lower_bound(
+        std::make_tuple(dest, tag, count, (TimeStamp)0, min_int));
+    if (it == any_source_index.end() || std::get<0>(*it) != dest ||
+        std::get<1>(*it) != tag || std::get<2>(*it) != count) {
+      return false;
+    }
+    key = make_key(tag, std::get<4>(*it), dest, count);
+    return true;
+  }
+
+  auto it = any_tag_index.lower_bound(
+      std::make_tuple(dest, src, count, (TimeStamp)0, min_int));
+  if (it == any_tag_index.end() || std::get<0>(*it) != dest ||
+      std::get<1>(*it) != src || std::get<2>(*it) != count) {
+    return false;
+  }
+  key = make_key(std::get<4>(*it), src, dest, count);
+  return true;
+}
+
+void Analytical::SendRecvTrackingMap::enable_wildcard_indices() noexcept {
+  if (wildcard_indices_enabled) {
+    return;
+  }
+
+  // index the oldest pending send of every key
+  wildcard_indices_enabled = true;
+  for (const auto& entry : slots) {
+    if (entry.occupied && entry.value.is_send()) {
+      wildcard_indices_insert(entry.key, entry.value.get_send_finish_time());
+    }
+  }
+}
+
+void Analytical::SendRecvTrackingMap::wildcard_indices_insert(
+    const Key& key,
+    TimeStamp send_finish_time) noexcept {
+  int tag, src, dest, count;
+  std::tie(tag, src, dest, count) = unpack_key(key);
+
+  any_source_index.emplace(dest, tag, count, send_finish_time, src);
+  any_tag_index.emplace(dest, src, count, send_finish_time, tag);
+  any_source_tag_index.emplace(dest, count, send_finish_time, tag, src);
+  update_peak_memory_usage();
+}
+
+void Analytical::SendRecvTrackingMap::wildcard_indices_erase(
+    const Key& key,
+    TimeStamp send_finish_time) noexcept {
+  int tag, src, dest, count;
+  std::tie(tag, src, dest, count) = unpack_key(key);
+
+  any_source_index.erase(
+      std::make_tuple(dest, tag, count, send_finish_time, src));
+  any_tag_index.erase(std::make_tuple(dest, src, count, send_finish_time, tag));
+  any_source_tag_index.erase(
+      std::make_tuple(dest, count, send_finish_time, tag, src));
+}
+
+uint32_t Analytical::SendRecvTrackingMap::acquire_node(
+    const SendRecvTrackingMapValue& value) noexcept {
+  if (free_node == no_node) {
+    // no node to recycle: grow the pool
+    nodes.push_back({value, no_node});
+    update_peak_memory_usage();
+    return (uint32_t)(nodes.size() - 1);
+  }
+
+  auto node = free_node;
+  free_node = nodes[node].next;
+  nodes[node] = {value, no_node};
+  return node;
+}
+
+void Analytical::SendRecvTrackingMap::release_node(uint32_t node) noexcept {
+  nodes[node].next = free_node;
+  free_node = node;
+}
+
+void Analytical::SendRecvTrackingMap::update_peak_memory_usage() noexcept {
+  peak_memory_usage = std::max(peak_memory_usage, get_memory_usage());
+}
+
+void Analytical::SendRecvTrackingMap::erase(size_t slot) noexcept {
+  auto mask = slots.size() - 1;
+
+  // backward-shift deletion: move following entries of the probe chain
+  // into the hole, so that no tombstone is required
+  auto hole = slot;
+  auto next = (hole + 1) & mask;
+  while (slots[next].occupied) {
+    auto home = home_slot(slots[next].key);
+    // move slots[next] only if its home slot is not within (hole, next]
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      slots[hole] = slots[next];
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+  slots[hole].occupied = false;
+  occupied_slots_count--;
+}
+
+void Analytical::SendRecvTrackingMap::grow() noexcept {
+  auto old_slots = std::vector<Slot>(slots.size() * 2);
+  old_slots.swap(slots);
+
+  auto mask = slots.size() - 1;
+  for (const auto& old_slot : old_slots) {
+    if (old_slot.occupied) {
+      auto slot = home_slot(old_slot.key);
+      while (slots[slot].occupied) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = old_slot;
+    }
+  }
 
-  send_recv_tracking_map.emplace(
-      std::make_tuple(tag, src, dest, count),
-      SendRecvTrackingMapValue::make_recv_value(fun_ptr, fun_arg));
+  // old_slots is freed only after the new slots are allocated
+  peak_memory_usage = std::max(
+      peak_memory_usage,
+      get_memory_usage() + (old_slots.capacity() * sizeof(Slot)));
 }
 
 void Analytical::SendRecvTrackingMap::print() const noexcept {
-  std::cout << "[SendRecvTrackingMap] Entries not processed: "
-            << send_recv_tracking_map.size() << std::endl;
+  std::cout << "[SendRecvTrackingMap] Entries not processed: " << entries_count
+            << " (peak: " << peak_entries_count
+            << ", memory: " << get_memory_usage() / 1024
+            << " KiB, peak memory: " << get_peak_memory_usage() / 1024
+            << " KiB)" << std::endl;
 }
@@ -6,94 +6,172 @@ LICENSE file in the root directory of this source tree.
 #ifndef __SENDRECVTRACKINGMAP_HH__
 #define __SENDRECVTRACKINGMAP_HH__
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <set>
 #include <tuple>
+#include <vector>
+#include "../event-queue/Event.hh"
+#include "../event-queue/EventKey.hh"
+#include "../event-queue/TimeStamp.hh"
 #include "SendRecvTrackingMapValue.hh"
-#include "astra-sim/system/AstraNetworkAPI.hh"
+#include "WaitHistogram.hh"
 
 namespace Analytical {
+/**
+ * Pending send and recv operations, keyed by (tag, src, dest, count).
+ * Each network owns the map of operations destined to its npu.
+ *
+ * Flat open-addressing (linear probing) hash table over a packed 128-bit
+ * key. Matching an operation against a pending operation of the opposite
+ * type, or tracking it when there is none, probes the table only once.
+ *
+ * Several operations of the same type may be pending with the same key
+ * (e.g., pipelined chunks of a collective): they are matched in FIFO
+ * order, as MPI does. The oldest operation is stored in the table slot,
+ * and the following ones in a queue of pooled nodes.
+ * No allocation happens once the table and the node pool have grown to
+ * the peak number of pending operations.
+ *
+ * A recv operation may accept any source (any_source) and/or any tag
+ * (any_tag). It matches the pending send operation that arrives first
+ * (earliest send_finish_time), looked up in ordered wildcard indices of
+ * the oldest pending send of each key. The indices are only built once
+ * the first wildcard recv is posted, so exact matching pays nothing for
+ * them otherwise. A send operation matches the earliest posted recv
+ * operation among the exact and wildcard ones accepting it.
+ *
+ * Each match records, at constant cost, how long the recv operation
+ * waited for its send to be posted (late sender) and how long the
+ * finished send waited for its recv to be posted (late receiver).
+ */
 class SendRecvTrackingMap {
  public:
   /**
-   * Check whether send operation with given key entry exists.
-   * @param tag
-   * @param src
-   * @param dest
-   * @param count
-   * @return true if send operation exists, false if not
+   * src of a recv operation accepting any source
    */
-  bool has_send_operation(int tag, int src, int dest, int count) const noexcept;
+  static constexpr int any_source = -1;
 
   /**
-   * Check whether recv operation with given key entry exists.
-   * @param tag
-   * @param src
-   * @param dest
-   * @param count
-   * @return true if recv operation exists, false if not
+   * tag of a recv operation accepting any tag
    */
-  bool has_recv_operation(int tag, int src, int dest, int count) const noexcept;
+  static constexpr int any_tag = -1;
 
   /**
-   * Remove the send operation entry with given key, and return send_finish_time
-   * value. Assertion: send_operation with given key must exist.
-   * @param tag
-   * @param src
-   * @param dest
-   * @param count
-   * @return send_finish_time value
+   * A pending send or recv operation, as listed by get_pending_operations.
    */
-  AstraSim::timespec_t pop_send_finish_time(
-      int tag,
-      int src,
-      int dest,
-      int count) noexcept;
+  struct PendingOperation {
+    bool is_send;
+    int tag;
+    int src;
+    int dest;
+    int count;
+    TimeStamp post_time;
+  };
 
-  /**
-   * Remove the recv operation entry with given key, and return
-   * recv_event_handler value. Assertion: recv operation with given key must
-   * exist.
-   * @param tag
-   * @param src
-   * @param dest
-   * @param count
-   * @return recv_event_handler
-   */
-  Event pop_recv_event_handler(int tag, int src, int dest, int count) noexcept;
+  SendRecvTrackingMap() noexcept;
 
   /**
-   * Insert a new send operation with given key.
-   *      Assertion: given key entry should not exist in the map
+   * Match a send operation against the earliest posted pending recv
+   * operation accepting it, removing the recv operation. If there is no
+   * such recv operation, track the send operation instead (after any send
+   * operation already pending with the same key).
    * @param tag
    * @param src
    * @param dest
    * @param count
+   * @param post_time time the send operation is posted
    * @param send_finish_time send_finish_time to write into the table
+   * @param send_key key of the events issued by the send operation
+   * @param recv_event set to the matched recv event handler
+   * @param recv_key set to the key of the matched recv operation
+   * @return true if a recv operation is matched (recv_event and recv_key
+   *         are set), false if the send operation got tracked
    */
-  void insert_send(
+  bool match_or_insert_send(
       int tag,
       int src,
       int dest,
       int count,
-      AstraSim::timespec_t send_finish_time) noexcept;
+      TimeStamp post_time,
+      TimeStamp send_finish_time,
+      const EventKey& send_key,
+      Event& recv_event,
+      EventKey& recv_key) noexcept;
 
   /**
-   * Insert a new recv operation with given key.
-   *      Assertion: given key entry should not exist in the map.
-   * @param tag
-   * @param src
+   * Match a recv operation against the oldest pending send operation with
+   * the same key, removing the send operation. If there is no such send
+   * operation, track the recv operation instead (after any recv operation
+   * already pending with the same key).
+   * With any_source or any_tag, the send operation arriving first among
+   * the oldest pending sends of every accepted key is matched.
+   * @param tag tag, or any_tag
+   * @param src src, or any_source
    * @param dest
    * @param count
-   * @param fun_ptr recv event handler
-   * @param fun_arg recv event handler argument
+   * @param post_time time the recv operation is posted
+   * @param recv_event recv event handler to write into the table
+   * @param recv_key key of the events issued by the recv operation
+   * @param send_finish_time set to send_finish_time of the matched send
+   * @param send_key set to the key of the matched send operation
+   * @return true if a send operation is matched (send_finish_time and
+   *         send_key are set), false if the recv operation got tracked
    */
-  void insert_recv(
+  bool match_or_insert_recv(
       int tag,
       int src,
       int dest,
       int count,
-      void (*fun_ptr)(void*),
-      void* fun_arg) noexcept;
+      TimeStamp post_time,
+      const Event& recv_event,
+      const EventKey& recv_key,
+      TimeStamp& send_finish_time,
+      EventKey& send_key) noexcept;
+
+  /**
+   * @return number of pending send and recv operations
+   */
+  size_t size() const noexcept;
+
+  /**
+   * Find the oldest pending operation.
+   * (Only scans the oldest operation of each key)
+   * @return post_time of the oldest pending operation,
+   *         max TimeStamp if no operation is pending
+   */
+  TimeStamp get_oldest_post_time() const noexcept;
+
+  /**
+   * List every pending operation.
+   * @param pending_operations vector to append the operations into
+   */
+  void get_pending_operations(
+      std::vector<PendingOperation>& pending_operations) const noexcept;
+
+  /**
+   * @return memory (in bytes) currently held by the table
+   */
+  size_t get_memory_usage() const noexcept;
+
+  /**
+   * @return peak memory (in bytes) held by the table
+   */
+  size_t get_peak_memory_usage() const noexcept;
+
+  /**
+   * Waits of matched recv operations: send post_time - recv post_time,
+   * 0 if the send operation was posted first.
+   * @return late sender wait histogram
+   */
+  const WaitHistogram& get_late_sender_histogram() const noexcept;
+
+  /**
+   * Waits of matched send operations: recv post_time - send_finish_time,
+   * 0 if the recv operation was posted before the send finished.
+   * @return late receiver wait histogram
+   */
+  const WaitHistogram& get_late_receiver_histogram() const noexcept;
 
   /**
    * For debugging purpose: print status for debugging.
@@ -102,15 +180,245 @@ class SendRecvTrackingMap {
 
  private:
   /**
-   * tag, src, dest, count
+   * (tag, src, dest, count) packed into 128 bits
    */
-  typedef std::tuple<int, int, int, int> Key;
+  struct Key {
+    uint64_t tag_src;
+    uint64_t dest_count;
+
+    bool operator==(const Key& other) const noexcept {
+      return tag_src == other.tag_src && dest_count == other.dest_count;
+    }
+  };
 
   /**
-   * Send and recv tracking map
+   * Table slot: occupied slot holds the oldest pending operation of its key.
+   * Pending operations following it are queued in queue_head ... queue_tail.
+   */
+  struct Slot {
+    bool occupied = false;
+    uint32_t queued_count = 0;
+    uint32_t queue_head;
+    uint32_t queue_tail;
+    Key key;
+    SendRecvTrackingMapValue value;
+  };
+
+  /**
+   * Queued pending operation, linked to the next one of the same key.
+   * A free node is linked to the next free node.
+   */
+  struct Node {
+    SendRecvTrackingMapValue value;
+    uint32_t next;
+  };
+
+  /**
+   * null node index
+   */
+  static constexpr uint32_t no_node = UINT32_MAX;
+
+  /**
+   * initial number of slots (should be power of 2)
+   */
+  static constexpr size_t initial_capacity = 8;
+
+  /**
+   * Wildcard index entries of the oldest pending send of each key:
+   *   - any_source: (dest, tag, count, send_finish_time, src)
+   *   - any_tag: (dest, src, count, send_finish_time, tag)
+   *   - any_source and any_tag: (dest, count, send_finish_time, tag, src)
+   * Entries of an index are ordered by arrival (send_finish_time) among
+   * the send operations a wildcard recv accepts.
+   */
+  typedef std::tuple<int, int, int, TimeStamp, int> WildcardIndexEntry;
+  typedef std::tuple<int, int, TimeStamp, int, int> AnyIndexEntry;
+
+  /**
+   * Pack (tag, src, dest, count) into a Key.
+   * @param tag
+   * @param src
+   * @param dest
+   * @param count
+   * @return packed key
+   */
+  static Key make_key(int tag, int src, int dest, int count) noexcept;
+
+  /**
+   * Unpack a Key into (tag, src, dest, count).
+   * @param key
+   * @return (tag, src, dest, count)
+   */
+  static std::tuple<int, int, int, int> unpack_key(const Key& key) noexcept;
+
+  /**
+   * Compute the home slot of given key.
+   * @param key
+   * @return slot index
+   */
+  size_t home_slot(const Key& key) const noexcept;
+
+  /**
+   * Find the slot holding given key, or the empty slot ending its probe
+   * chain.
+   * @param key
+   * @return slot index
+   */
+  size_t find(const Key& key) const noexcept;
+
+  /**
+   * Append an operation to the operations pending with given key.
+   * @param key
+   * @param value operation to track
+   */
+  void push_back(const Key& key, const SendRecvTrackingMapValue& value) noexcept;
+
+  /**
+   * Remove the oldest operation pending in given slot.
+   * @param slot occupied slot index
+   * @return removed operation
+   */
+  SendRecvTrackingMapValue pop_front(size_t slot) noexcept;
+
+  /**
+   * Find the pending recv operation a send operation would match.
+   * @param key key of the send operation
+   * @return slot index of the earliest posted recv operation accepting the
+   *         send operation, or slots.size() if there is none
+   */
+  size_t find_recv(const Key& key) const noexcept;
+
+  /**
+   * Find the pending send operation a wildcard recv operation would match.
+   * @param tag tag, or any_tag
+   * @param src src, or any_source
+   * @param dest
+   * @param count
+   * @param key set to the key of the send operation arriving first
+   * @return true if a send operation is found (key is set), false otherwise
+   */
+  bool find_wildcard_send(int tag, int src, int dest, int count, Key& key)
+      const noexcept;
+
+  /**
+   * Build the wildcard indices from the pending send operations.
+   */
+  void enable_wildcard_indices() noexcept;
+
+  /**
+   * Add (or remove) the oldest pending send of a key to the wildcard
+   * indices.
+   * @param key
+   * @param send_finish_time
+   */
+  void wildcard_indices_insert(const Key& key, TimeStamp send_finish_time)
+      noexcept;
+  void wildcard_indices_erase(const Key& key, TimeStamp send_finish_time)
+      noexcept;
+
+  /**
+   * Take a node from the node pool.
+   * @param value value of the node
+   * @return node index
+   */
+  uint32_t acquire_node(const SendRecvTrackingMapValue& value) noexcept;
+
+  /**
+   * Return a node to the node pool.
+   * @param node node index
+   */
+  void release_node(uint32_t node) noexcept;
+
+  /**
+   * Record the waits of a matched pair of send and recv operations.
+   * @param send_post_time
+   * @param send_finish_time
+   * @param recv_post_time
+   */
+  void record_waits(
+      TimeStamp send_post_time,
+      TimeStamp send_finish_time,
+      TimeStamp recv_post_time) noexcept;
+
+  /**
+   * Update peak_memory_usage with the current memory usage.
+   */
+  void update_peak_memory_usage() noexcept;
+
+  /**
+   * Empty a slot, shifting the rest of its probe chain backward.
+   * @param slot slot index
+   */
+  void erase(size_t slot) noexcept;
+
+  /**
+   * Double the number of slots and re-insert every pending operation.
+   */
+  void grow() noexcept;
+
+  /**
+   * Send and recv tracking table
    * (tag, src, dest, count) -> Value
    */
-  std::map<Key, SendRecvTrackingMapValue> send_recv_tracking_map;
+  std::vector<Slot> slots;
+
+  /**
+   * pool of queue nodes
+   */
+  std::vector<Node> nodes;
+
+  /**
+   * head of the free node list
+   */
+  uint32_t free_node = no_node;
+
+  /**
+   * number of occupied slots (i.e., distinct pending keys)
+   */
+  size_t occupied_slots_count = 0;
+
+  /**
+   * number of pending operations
+   */
+  size_t entries_count = 0;
+
+  /**
+   * peak number of pending operations
+   */
+  size_t peak_entries_count = 0;
+
+  /**
+   * peak memory (in bytes) held by slots and nodes
+   */
+  size_t peak_memory_usage = 0;
+
+  /**
+   * number of recv operations posted so far
+   */
+  uint64_t posted_recvs_count = 0;
+
+  /**
+   * number of pending wildcard recv operations
+   */
+  size_t wildcard_recvs_count = 0;
+
+  /**
+   * whether the wildcard indices are maintained
+   */
+  bool wildcard_indices_enabled = false;
+
+  /**
+   * wildcard indices (see WildcardIndexEntry)
+   */
+  std::set<WildcardIndexEntry> any_source_index;
+  std::set<WildcardIndexEntry> any_tag_index;
+  std::set<AnyIndexEntry> any_source_tag_index;
+
+  /**
+   * waits of matched operations
+   */
+  WaitHistogram late_sender_histogram;
+  WaitHistogram late_receiver_histogram;
 };
 } // namespace Analytical
 
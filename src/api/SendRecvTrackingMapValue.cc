@@ -5,14 +5,36 @@ LICENSE file in the root directory of this source tree.
 
 #include "SendRecvTrackingMapValue.hh"
 
+#include <cassert>
+
 Analytical::SendRecvTrackingMapValue Analytical::SendRecvTrackingMapValue::
-    make_send_value(AstraSim::timespec_t send_finish_time) noexcept {
-  return {OperationType::send, send_finish_time, nullptr, nullptr};
+    make_send_value(
+        TimeStamp post_time,
+        TimeStamp send_finish_time,
+        const EventKey& event_key) noexcept {
+  assert(
+      event_key.issue_time == post_time &&
+      "<SendRecvTrackingMapValue::make_send_value> key issue_time mismatch");
+  return {
+      OperationType::send, post_time, send_finish_time, Event(), event_key, 0};
 }
 
 Analytical::SendRecvTrackingMapValue Analytical::SendRecvTrackingMapValue::
-    make_recv_value(void (*fun_ptr)(void*), void* fun_arg) noexcept {
-  return {OperationType::recv, AstraSim::timespec_t(), fun_ptr, fun_arg};
+    make_recv_value(
+        TimeStamp post_time,
+        const Event& recv_event,
+        const EventKey& event_key,
+        uint64_t sequence_number) noexcept {
+  assert(
+      event_key.issue_time == post_time &&
+      "<SendRecvTrackingMapValue::make_recv_value> key issue_time mismatch");
+  return {
+      OperationType::recv,
+      post_time,
+      0,
+      recv_event,
+      event_key,
+      sequence_number};
 }
 
 bool Analytical::SendRecvTrackingMapValue::is_send() const noexcept {
@@ -23,7 +45,12 @@ bool Analytical::SendRecvTrackingMapValue::is_recv() const noexcept {
   return operation_type == OperationType::recv;
 }
 
-AstraSim::timespec_t Analytical::SendRecvTrackingMapValue::
+Analytical::TimeStamp Analytical::SendRecvTrackingMapValue::get_post_time()
+    const noexcept {
+  return post_time;
+}
+
+Analytical::TimeStamp Analytical::SendRecvTrackingMapValue::
     get_send_finish_time() const noexcept {
   return send_finish_time;
 }
@@ -32,3 +59,13 @@ Analytical::Event Analytical::SendRecvTrackingMapValue::get_recv_event()
     const noexcept {
   return recv_event;
 }
+
+Analytical::EventKey Analytical::SendRecvTrackingMapValue::get_event_key()
+    const noexcept {
+  return {post_time, event_issuer, event_sequence};
+}
+
+uint64_t Analytical::SendRecvTrackingMapValue::get_sequence_number()
+    const noexcept {
+  return sequence_number;
+}
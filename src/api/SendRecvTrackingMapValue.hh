@@ -6,30 +6,54 @@ LICENSE file in the root directory of this source tree.
 #ifndef __SENDRECVTRACKINGMAPVALUE_HH__
 #define __SENDRECVTRACKINGMAPVALUE_HH__
 
+#include <cstdint>
 #include "../event-queue/Event.hh"
-#include "../event-queue/EventQueueEntry.hh"
-#include "astra-sim/system/AstraNetworkAPI.hh"
+#include "../event-queue/EventKey.hh"
+#include "../event-queue/TimeStamp.hh"
 
 namespace Analytical {
 class SendRecvTrackingMapValue {
  public:
+  /**
+   * Construct an empty value.
+   * (Only used to fill pre-allocated table slots.)
+   */
+  SendRecvTrackingMapValue() noexcept
+      : SendRecvTrackingMapValue(
+            OperationType::send,
+            0,
+            0,
+            Event(),
+            EventKey(),
+            0) {}
+
   /**
    * Constructor for send operation
+   * @param post_time time the send operation is posted
    * @param send_finish_time send operation finish time
+   * @param event_key key of the events issued by the send operation
+   *                  (issued at post_time)
    * @return instance with send operation set
    */
   static SendRecvTrackingMapValue make_send_value(
-      AstraSim::timespec_t send_finish_time) noexcept;
+      TimeStamp post_time,
+      TimeStamp send_finish_time,
+      const EventKey& event_key) noexcept;
 
   /**
    * Constructor for recv operation
-   * @param fun_ptr recv event handler
-   * @param fun_arg recv event handler argument
+   * @param post_time time the recv operation is posted
+   * @param recv_event recv event handler
+   * @param event_key key of the events issued by the recv operation
+   *                  (issued at post_time)
+   * @param sequence_number order in which the recv operation was posted
    * @return instance with recv operation set
    */
   static SendRecvTrackingMapValue make_recv_value(
-      void (*fun_ptr)(void*),
-      void* fun_arg) noexcept;
+      TimeStamp post_time,
+      const Event& recv_event,
+      const EventKey& event_key,
+      uint64_t sequence_number) noexcept;
 
   /**
    * Check whether the operation is send.
@@ -43,11 +67,17 @@ class SendRecvTrackingMapValue {
    */
   bool is_recv() const noexcept;
 
+  /**
+   * post_time getter
+   * @return post_time
+   */
+  TimeStamp get_post_time() const noexcept;
+
   /**
    * send_finish_time getter
    * @return send_finish_timme
    */
-  AstraSim::timespec_t get_send_finish_time() const noexcept;
+  TimeStamp get_send_finish_time() const noexcept;
 
   /**
    * recv_event getter
@@ -55,36 +85,77 @@ class SendRecvTrackingMapValue {
    */
   Event get_recv_event() const noexcept;
 
+  /**
+   * event_key getter
+   * @return key of the events issued when the operation was posted
+   */
+  EventKey get_event_key() const noexcept;
+
+  /**
+   * sequence_number getter
+   * @return sequence_number
+   */
+  uint64_t get_sequence_number() const noexcept;
+
  private:
   enum class OperationType { send, recv };
   OperationType operation_type;
 
+  /**
+   * Issuer and sequence of the key of the events issued when the operation
+   * was posted (its issue_time is post_time). The recv event handler is
+   * keyed by the later of the send and recv keys.
+   * (Stored apart to keep the value compact)
+   */
+  int event_issuer;
+  uint32_t event_sequence;
+
+  /**
+   * Time the operation was posted (i.e., sim_send or sim_recv was called)
+   */
+  TimeStamp post_time;
+
   /**
    * For send operation: mark when send should finish
    * Note: this is an actual time of event_queue, not delta
    */
-  AstraSim::timespec_t send_finish_time;
+  TimeStamp send_finish_time;
 
   /**
    * For recv operation: save receive event handler
    */
   Event recv_event;
 
+  /**
+   * For recv operation: order in which recv operations were posted
+   * (exact and wildcard recv operations are matched in this order)
+   */
+  uint64_t sequence_number;
+
   /**
    * Hidden constructor
    * @param operation_type send/recv event type
+   * @param post_time time the operation is posted
    * @param send_finish_time for send -- send operation ending time
-   * @param fun_ptr for recv operation -- recv event handler
-   * @param fun_arg for recv operation -- recv event handler argument
+   * @param recv_event for recv operation -- recv event handler
+   * @param event_key key of the events issued by the operation
+   *                  (issued at post_time)
+   * @param sequence_number for recv operation -- posting order
    */
   SendRecvTrackingMapValue(
       OperationType operation_type,
-      AstraSim::timespec_t send_finish_time,
-      void (*fun_ptr)(void*),
-      void* fun_arg) noexcept
+      TimeStamp post_time,
+      TimeStamp send_finish_time,
+      const Event& recv_event,
+      const EventKey& event_key,
+      uint64_t sequence_number) noexcept
       : operation_type(operation_type),
+        event_issuer(event_key.issuer),
+        event_sequence(event_key.sequence),
+        post_time(post_time),
         send_finish_time(send_finish_time),
-        recv_event(fun_ptr, fun_arg) {}
+        recv_event(recv_event),
+        sequence_number(sequence_number) {}
 };
 } // namespace Analytical
 
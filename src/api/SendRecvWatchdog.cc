@@ -0,0 +1,258 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "SendRecvWatchdog.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <tuple>
+
+namespace {
+/**
+ * Unmatched operations of the same type within (src, dest, tag) ranges.
+ */
+struct OperationGroup {
+  bool is_send;
+  int src_min, src_max;
+  int dest_min, dest_max;
+  int tag_min, tag_max;
+  size_t operations_count;
+  Analytical::TimeStamp oldest_post_time;
+};
+
+/**
+ * Merge groups that are equal except for one range, whose ranges are
+ * contiguous once sorted.
+ * @param groups groups to merge (reordered)
+ * @param range member pointers to the (min, max) of the range to merge
+ * @param other_fields tuple of the fields that should match
+ */
+template <typename OtherFields>
+void merge_groups(
+    std::vector<OperationGroup>& groups,
+    int OperationGroup::*range_min,
+    int OperationGroup::*range_max,
+    OtherFields other_fields) noexcept {
+  std::sort(
+      groups.begin(),
+      groups.end(),
+      [&](const OperationGroup& group_a, const OperationGroup& group_b) {
+        return std::make_tuple(other_fields(group_a), group_a.*range_min) <
+            std::make_tuple(other_fields(group_b), group_b.*range_min);
+      });
+
+  auto merged_groups = std::vector<OperationGroup>();
+  for (const auto& group : groups) {
+    if (!merged_groups.empty()) {
+      auto& last_group = merged_groups.back();
+      if (other_fields(last_group) == other_fields(group) &&
+          group.*range_min <= last_group.*range_max + 1) {
+        last_group.*range_max =
+            std::max(last_group.*range_max, group.*range_max);
+        last_group.operations_count += group.operations_count;
+        last_group.oldest_post_time =
+            std::min(last_group.oldest_post_time, group.oldest_post_time);
+        continue;
+      }
+    }
+    merged_groups.push_back(group);
+  }
+  groups.swap(merged_groups);
+}
+
+/**
+ * Print a range as "min" or "min-max".
+ */
+std::string range_to_string(int min, int max) noexcept {
+  if (min == max) {
+    return std::to_string(min);
+  }
+  return std::to_string(min) + "-" + std::to_string(max);
+}
+} // namespace
+
+Analytical::SendRecvWatchdog::SendRecvWatchdog(
+    TimeStamp pending_age_bound) noexcept
+    : pending_age_bound(pending_age_bound),
+      next_check_time(
+          pending_age_bound > 0 ? pending_age_bound / 4
+                                : std::numeric_limits<TimeStamp>::max()),
+      last_reported_post_time(std::numeric_limits<TimeStamp>::max()) {}
+
+bool Analytical::SendRecvWatchdog::is_enabled() const noexcept {
+  return pending_age_bound > 0;
+}
+
+Analytical::TimeStamp Analytical::SendRecvWatchdog::get_next_check_time()
+    const noexcept {
+  return next_check_time;
+}
+
+void Analytical::SendRecvWatchdog::check_pending_age(
+    const SendRecvTrackingMaps& send_recv_tracking_maps,
+    TimeStamp current_time) noexcept {
+  if (!is_enabled() || current_time < next_check_time) {
+    return;
+  }
+  next_check_time = current_time + std::max<TimeStamp>(pending_age_bound / 4, 1);
+
+  auto oldest_post_time = std::numeric_limits<TimeStamp>::max();
+  for (const auto send_recv_tracking_map : send_recv_tracking_maps) {
+    oldest_post_time = std::min(
+        oldest_post_time, send_recv_tracking_map->get_oldest_post_time());
+  }
+
+  if (oldest_post_time == std::numeric_limits<TimeStamp>::max() ||
+      current_time - oldest_post_time <= pending_age_bound ||
+      oldest_post_time == last_reported_post_time) {
+    // nothing (new) to report
+    return;
+  }
+  last_reported_post_time = oldest_post_time;
+
+  auto pending_operations =
+      collect_pending_operations(send_recv_tracking_maps);
+  auto output = std::ostringstream();
+  output << "[SendRecvWatchdog] Warning: operation pending for "
+         << (current_time - oldest_post_time) / 1000.0 << " ns (bound: "
+         << pending_age_bound / 1000.0 << " ns) at " << current_time / 1000.0
+         << " ns, " << pending_operations.size() << " operation(s) pending"
+         << std::endl;
+  print_oldest_operations(pending_operations, current_time, output);
+  std::cout << output.str() << std::flush;
+}
+
+bool Analytical::SendRecvWatchdog::report_unmatched(
+    const SendRecvTrackingMaps& send_recv_tracking_maps,
+    TimeStamp current_time) noexcept {
+  auto pending_operations =
+      collect_pending_operations(send_recv_tracking_maps);
+  if (pending_operations.empty()) {
+    return true;
+  }
+
+  // one group per operation, then merge contiguous src, dest and tag
+  auto groups = std::vector<OperationGroup>();
+  for (const auto& operation : pending_operations) {
+    groups.push_back(
+        {operation.is_send,
+         operation.src,
+         operation.src,
+         operation.dest,
+         operation.dest,
+         operation.tag,
+         operation.tag,
+         1,
+         operation.post_time});
+  }
+  merge_groups(
+      groups,
+      &OperationGroup::src_min,
+      &OperationGroup::src_max,
+      [](const OperationGroup& group) {
+        return std::make_tuple(
+            group.is_send,
+            group.tag_min,
+            group.tag_max,
+            group.dest_min,
+            group.dest_max);
+      });
+  merge_groups(
+      groups,
+      &OperationGroup::dest_min,
+      &OperationGroup::dest_max,
+      [](const OperationGroup& group) {
+        return std::make_tuple(
+            group.is_send,
+            group.tag_min,
+            group.tag_max,
+            group.src_min,
+            group.src_max);
+      });
+  merge_groups(
+      groups,
+      &OperationGroup::tag_min,
+      &OperationGroup::tag_max,
+      [](const OperationGroup& group) {
+        return std::make_tuple(
+            group.is_send,
+            group.src_min,
+            group.src_max,
+            group.dest_min,
+            group.dest_max);
+      });
+
+  // largest groups first
+  std::sort(
+      groups.begin(),
+      groups.end(),
+      [](const OperationGroup& group_a, const OperationGroup& group_b) {
+        return group_a.operations_count > group_b.operations_count;
+      });
+
+  auto output = std::ostringstream();
+  output << "[SendRecvWatchdog] Error: event queue drained at "
+         << current_time / 1000.0 << " ns with " << pending_operations.size()
+         << " unmatched operation(s) in " << groups.size() << " group(s)"
+         << std::endl;
+  for (auto i = 0; i < (int)groups.size() && i < groups_count; i++) {
+    const auto& group = groups[i];
+    output << "\t- " << (group.is_send ? "send" : "recv") << " src "
+           << range_to_string(group.src_min, group.src_max) << " -> dest "
+           << range_to_string(group.dest_min, group.dest_max) << ", tag "
+           << range_to_string(group.tag_min, group.tag_max) << ": "
+           << group.operations_count
+           << " operation(s), oldest posted at "
+           << group.oldest_post_time / 1000.0 << " ns" << std::endl;
+  }
+  if ((int)groups.size() > groups_count) {
+    output << "\t- ... " << (groups.size() - groups_count) << " more group(s)"
+           << std::endl;
+  }
+  print_oldest_operations(pending_operations, current_time, output);
+  std::cout << output.str() << std::flush;
+  return false;
+}
+
+std::vector<Analytical::SendRecvWatchdog::PendingOperation> Analytical::
+    SendRecvWatchdog::collect_pending_operations(
+        const SendRecvTrackingMaps& send_recv_tracking_maps) noexcept {
+  auto pending_operations = std::vector<PendingOperation>();
+  for (const auto send_recv_tracking_map : send_recv_tracking_maps) {
+    send_recv_tracking_map->get_pending_operations(pending_operations);
+  }
+  return pending_operations;
+}
+
+void Analytical::SendRecvWatchdog::print_oldest_operations(
+    std::vector<PendingOperation>& pending_operations,
+    TimeStamp current_time,
+    std::ostream& output) noexcept {
+  auto samples = (int)pending_operations.size();
+  if (samples > samples_count) {
+    samples = samples_count;
+  }
+  std::partial_sort(
+      pending_operations.begin(),
+      pending_operations.begin() + samples,
+      pending_operations.end(),
+      [](const PendingOperation& operation_a,
+         const PendingOperation& operation_b) {
+        return operation_a.post_time < operation_b.post_time;
+      });
+
+  output << "[SendRecvWatchdog] Oldest pending operations:" << std::endl;
+  for (auto i = 0; i < samples; i++) {
+    const auto& operation = pending_operations[i];
+    output << "\t- " << (operation.is_send ? "send" : "recv") << " src "
+           << operation.src << " -> dest " << operation.dest << ", tag "
+           << operation.tag << ", count " << operation.count
+           << ": posted at " << operation.post_time / 1000.0 << " ns ("
+           << (current_time - operation.post_time) / 1000.0 << " ns ago)"
+           << std::endl;
+  }
+}
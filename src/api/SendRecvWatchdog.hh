@@ -0,0 +1,121 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __SENDRECVWATCHDOG_HH__
+#define __SENDRECVWATCHDOG_HH__
+
+#include <iostream>
+#include <vector>
+#include "../event-queue/TimeStamp.hh"
+#include "SendRecvTrackingMap.hh"
+
+namespace Analytical {
+/**
+ * Watchdog of send/recv operations left unmatched, e.g., by misconfigured
+ * tags in the workload.
+ *   - check_pending_age: warns once an operation stays pending longer than
+ *     pending_age_bound in simulated time. Checks are rate-limited to one
+ *     per quarter of the bound, so an operation is reported at most
+ *     1.25 * pending_age_bound after it was posted.
+ *   - report_unmatched: at the end of the run, groups the operations left
+ *     unmatched into (src, dest, tag) ranges.
+ * Every warning lists a sample of the oldest pending operations.
+ */
+class SendRecvWatchdog {
+ public:
+  using SendRecvTrackingMaps = std::vector<const SendRecvTrackingMap*>;
+
+  /**
+   * Construct a watchdog.
+   * @param pending_age_bound maximum time (in ps) an operation may stay
+   *                          pending before a warning (0: no bound)
+   */
+  explicit SendRecvWatchdog(TimeStamp pending_age_bound = 0) noexcept;
+
+  /**
+   * Check whether pending operations are bounded in age.
+   * @return true if pending_age_bound is set
+   */
+  bool is_enabled() const noexcept;
+
+  /**
+   * Time the next check_pending_age should be run at.
+   * @return next check time (in ps), max TimeStamp if not enabled
+   */
+  TimeStamp get_next_check_time() const noexcept;
+
+  /**
+   * Warn if an operation has been pending longer than pending_age_bound.
+   * Does nothing before the next check time.
+   * (send_recv_tracking_maps should not be modified during the check)
+   * @param send_recv_tracking_maps maps to check
+   * @param current_time current simulated time (in ps)
+   */
+  void check_pending_age(
+      const SendRecvTrackingMaps& send_recv_tracking_maps,
+      TimeStamp current_time) noexcept;
+
+  /**
+   * Report every operation left unmatched, grouped into
+   * (src, dest, tag) ranges.
+   * @param send_recv_tracking_maps maps to check
+   * @param current_time simulated time the run ended at (in ps)
+   * @return true if no operation is left unmatched, false otherwise
+   */
+  static bool report_unmatched(
+      const SendRecvTrackingMaps& send_recv_tracking_maps,
+      TimeStamp current_time) noexcept;
+
+ private:
+  using PendingOperation = SendRecvTrackingMap::PendingOperation;
+
+  /**
+   * number of oldest operations listed in a warning
+   */
+  static constexpr int samples_count = 8;
+
+  /**
+   * maximum number of (src, dest, tag) range groups listed in the report
+   */
+  static constexpr int groups_count = 32;
+
+  /**
+   * List the pending operations of all maps.
+   * @param send_recv_tracking_maps
+   * @return pending operations
+   */
+  static std::vector<PendingOperation> collect_pending_operations(
+      const SendRecvTrackingMaps& send_recv_tracking_maps) noexcept;
+
+  /**
+   * Print the oldest pending operations.
+   * @param pending_operations pending operations (reordered)
+   * @param current_time current simulated time (in ps)
+   * @param output stream to print into
+   */
+  static void print_oldest_operations(
+      std::vector<PendingOperation>& pending_operations,
+      TimeStamp current_time,
+      std::ostream& output) noexcept;
+
+  /**
+   * maximum pending time (in ps), 0 if not bounded
+   */
+  TimeStamp pending_age_bound;
+
+  /**
+   * time the next check is due
+   */
+  TimeStamp next_check_time;
+
+  /**
+   * post_time of the oldest operation reported so far
+   * (an operation is only reported once)
+   */
+  TimeStamp last_reported_post_time;
+};
+} // namespace Analytical
+
+#endif
@@ -0,0 +1,103 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "WaitHistogram.hh"
+
+#include <algorithm>
+#include <cmath>
+
+void Analytical::WaitHistogram::record(TimeStamp wait) noexcept {
+  buckets[bucket(wait)]++;
+  count++;
+  total += wait;
+  max = std::max(max, wait);
+}
+
+void Analytical::WaitHistogram::merge(const WaitHistogram& other) noexcept {
+  for (auto i = 0; i < buckets_count; i++) {
+    buckets[i] += other.buckets[i];
+  }
+  count += other.count;
+  total += other.total;
+  max = std::max(max, other.max);
+}
+
+uint64_t Analytical::WaitHistogram::get_count() const noexcept {
+  return count;
+}
+
+double Analytical::WaitHistogram::get_mean() const noexcept {
+  if (count == 0) {
+    return 0;
+  }
+  return (double)(total / count);
+}
+
+Analytical::TimeStamp Analytical::WaitHistogram::get_max() const noexcept {
+  return max;
+}
+
+Analytical::TimeStamp Analytical::WaitHistogram::get_percentile(
+    double percentile) const noexcept {
+  // rank of the wait, starting from 1
+  auto rank = (uint64_t)std::ceil((percentile / 100.0) * count);
+  rank = std::max<uint64_t>(rank, 1);
+
+  auto accumulated_count = (uint64_t)0;
+  for (auto i = 0; i < buckets_count; i++) {
+    accumulated_count += buckets[i];
+    if (accumulated_count >= rank) {
+      return std::min(bucket_upper_bound(i), max);
+    }
+  }
+  return max;
+}
+
+void Analytical::WaitHistogram::print_summary(
+    std::ostream& output) const noexcept {
+  output << "count " << count << ", mean " << get_mean() / 1000.0
+         << " ns, p50 <= " << get_percentile(50) / 1000.0 << " ns, p99 <= "
+         << get_percentile(99) / 1000.0 << " ns, max " << max / 1000.0
+         << " ns";
+}
+
+void Analytical::WaitHistogram::print(
+    const std::string& name,
+    std::ostream& output) const noexcept {
+  output << name << ": ";
+  print_summary(output);
+  output << std::endl;
+
+  for (auto i = 0; i < buckets_count; i++) {
+    if (buckets[i] == 0) {
+      continue;
+    }
+    auto lower_bound = (i == 0) ? 0 : bucket_upper_bound(i - 1) + 1;
+    output << "\t[" << lower_bound / 1000.0 << ", "
+           << bucket_upper_bound(i) / 1000.0 << "] ns: " << buckets[i]
+           << std::endl;
+  }
+}
+
+int Analytical::WaitHistogram::bucket(TimeStamp wait) noexcept {
+  // number of significant bits of wait
+  auto bits = 0;
+  while (wait != 0) {
+    wait >>= 1;
+    bits++;
+  }
+  return bits;
+}
+
+Analytical::TimeStamp Analytical::WaitHistogram::bucket_upper_bound(
+    int bucket) noexcept {
+  if (bucket == 0) {
+    return 0;
+  }
+  if (bucket == buckets_count - 1) {
+    return UINT64_MAX;
+  }
+  return ((TimeStamp)1 << bucket) - 1;
+}
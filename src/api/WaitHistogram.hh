@@ -0,0 +1,101 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __WAITHISTOGRAM_HH__
+#define __WAITHISTOGRAM_HH__
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "../event-queue/TimeStamp.hh"
+
+namespace Analytical {
+/**
+ * Histogram of wait times with power-of-two buckets:
+ * bucket 0 holds zero waits, and bucket i (i >= 1) waits in
+ * [2^(i-1), 2^i) ps. Recording is constant-time and never allocates.
+ */
+class WaitHistogram {
+ public:
+  /**
+   * Record a wait.
+   * @param wait wait time (in ps)
+   */
+  void record(TimeStamp wait) noexcept;
+
+  /**
+   * Add every wait recorded by another histogram.
+   * @param other
+   */
+  void merge(const WaitHistogram& other) noexcept;
+
+  /**
+   * @return number of recorded waits
+   */
+  uint64_t get_count() const noexcept;
+
+  /**
+   * @return mean wait (in ps), 0 if no wait is recorded
+   */
+  double get_mean() const noexcept;
+
+  /**
+   * @return longest wait (in ps)
+   */
+  TimeStamp get_max() const noexcept;
+
+  /**
+   * Estimate a percentile: upper bound of the bucket holding it.
+   * @param percentile percentile in [0, 100]
+   * @return wait (in ps)
+   */
+  TimeStamp get_percentile(double percentile) const noexcept;
+
+  /**
+   * Print summary statistics on a single line.
+   * @param output stream to print into
+   */
+  void print_summary(std::ostream& output) const noexcept;
+
+  /**
+   * Print summary statistics and every non-empty bucket.
+   * @param name name of the histogram
+   * @param output stream to print into
+   */
+  void print(const std::string& name, std::ostream& output) const noexcept;
+
+ private:
+  /**
+   * number of buckets: zero, then one per bit of TimeStamp
+   */
+  static constexpr int buckets_count = 65;
+
+  /**
+   * Compute the bucket of given wait.
+   * @param wait wait time (in ps)
+   * @return bucket index
+   */
+  static int bucket(TimeStamp wait) noexcept;
+
+  /**
+   * Largest wait of given bucket.
+   * @param bucket bucket index
+   * @return wait (in ps)
+   */
+  static TimeStamp bucket_upper_bound(int bucket) noexcept;
+
+  /**
+   * buckets[i]: number of waits in bucket i
+   */
+  std::array<uint64_t, buckets_count> buckets = {};
+
+  uint64_t count = 0;
+  long double total = 0;
+  TimeStamp max = 0;
+};
+} // namespace Analytical
+
+#endif
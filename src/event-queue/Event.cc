@@ -5,14 +5,13 @@ LICENSE file in the root directory of this source tree.
 
 #include "Event.hh"
 
-void Analytical::Event::run() const noexcept {
-  (*fun_ptr)(fun_arg);
-}
+#include <cassert>
 
-Analytical::Event::FunPtr Analytical::Event::get_fun_ptr() const noexcept {
-  return fun_ptr;
+bool Analytical::Event::empty() const noexcept {
+  return invoker == nullptr;
 }
 
-void* Analytical::Event::get_fun_arg() const noexcept {
-  return fun_arg;
+void Analytical::Event::run() const noexcept {
+  assert(invoker != nullptr && "<Event::run> running an empty event");
+  (*invoker)(storage);
 }
@@ -6,46 +6,117 @@ LICENSE file in the root directory of this source tree.
 #ifndef __EVENT_HH__
 #define __EVENT_HH__
 
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
 namespace Analytical {
+/**
+ * Type-erased event handler.
+ *
+ * An event either wraps a C-style handler (function pointer + argument),
+ * or a small callable (e.g., a lambda) stored inline in a fixed-size
+ * buffer, so that scheduling a closure never allocates.
+ * An inline callable should be trivially copyable (e.g., a lambda capturing
+ * pointers and integers by value), fit in storage_size bytes, and provide
+ * a const operator().
+ */
 struct Event {
  public:
   typedef void (*FunPtr)(void*);
 
+  /**
+   * size (in bytes) of the inline callable storage
+   */
+  static constexpr size_t storage_size = 40;
+
+  /**
+   * Construct an empty event.
+   * (Only used to fill pre-allocated event storage.)
+   */
+  Event() noexcept : invoker(nullptr), storage(){};
+
   /**
    * Construct new event.
    * @param fun_ptr pointer to event handler
    * @param fun_arg pointer to event handler argument
    */
   Event(void (*fun_ptr)(void*), void* fun_arg) noexcept
-      : fun_ptr(fun_ptr), fun_arg(fun_arg){};
+      : Event(FunctionCall{fun_ptr, fun_arg}){};
+
+  /**
+   * Construct new event running a callable.
+   * @tparam Callable type of the callable
+   * @param callable callable to run (copied into the event)
+   */
+  template <
+      typename Callable,
+      typename = typename std::enable_if<!std::is_same<
+          typename std::decay<Callable>::type,
+          Event>::value>::type>
+  explicit Event(const Callable& callable) noexcept
+      : invoker(&invoke<Callable>) {
+    static_assert(
+        sizeof(Callable) <= storage_size,
+        "<Event> callable is too large to be stored inline");
+    static_assert(
+        alignof(Callable) <= alignof(void*),
+        "<Event> callable is over-aligned");
+    static_assert(
+        std::is_trivially_copyable<Callable>::value,
+        "<Event> callable should be trivially copyable");
+    new (storage) Callable(callable);
+  }
+
+  /**
+   * Check whether this is an empty event (i.e., no handler).
+   * (Cancelled events are overwritten with an empty event.)
+   * @return true if the event has no handler, false otherwise
+   */
+  bool empty() const noexcept;
 
   /**
    * Run the event handler.
+   * Assertion: the event should not be empty.
    */
   void run() const noexcept;
 
+ private:
   /**
-   * fun_ptr getter
-   * @return fun_ptr
+   * Calls the callable held in storage.
    */
-  FunPtr get_fun_ptr() const noexcept;
+  typedef void (*Invoker)(const void*);
 
   /**
-   * fun_arg getter
-   * @return fun_arg
+   * C-style event handler, stored as a callable.
    */
-  void* get_fun_arg() const noexcept;
+  struct FunctionCall {
+    FunPtr fun_ptr;
+    void* fun_arg;
+
+    void operator()() const noexcept {
+      (*fun_ptr)(fun_arg);
+    }
+  };
+
+  /**
+   * Invoker of Callable type.
+   * @param storage storage holding the callable
+   */
+  template <typename Callable>
+  static void invoke(const void* storage) noexcept {
+    (*static_cast<const Callable*>(storage))();
+  }
 
- private:
   /**
-   * function pointer directing the event handler
+   * invoker matching the type of the stored callable
    */
-  FunPtr fun_ptr;
+  Invoker invoker;
 
   /**
-   * pointer to the event handler argument.
+   * inline storage of the callable
    */
-  void* fun_arg;
+  alignas(void*) unsigned char storage[storage_size];
 };
 } // namespace Analytical
 
@@ -0,0 +1,38 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __EVENTHANDLE_HH__
+#define __EVENTHANDLE_HH__
+
+#include <cstdint>
+
+namespace Analytical {
+struct EventQueueEntry;
+
+/**
+ * Handle of a scheduled event, returned by EventQueue::add_event.
+ * Refers to the event slot inside its EventQueueEntry. The generation
+ * tells whether the entry has been recycled since, so a handle to an event
+ * that already ran (or was cancelled) is detected as stale.
+ */
+struct EventHandle {
+  /**
+   * entry holding the event (nullptr: handle to no event)
+   */
+  EventQueueEntry* entry = nullptr;
+
+  /**
+   * generation of the entry when the event was added
+   */
+  uint64_t generation = 0;
+
+  /**
+   * position of the event inside the entry
+   */
+  int index = 0;
+};
+} // namespace Analytical
+
+#endif
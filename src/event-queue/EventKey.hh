@@ -0,0 +1,47 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __EVENTKEY_HH__
+#define __EVENTKEY_HH__
+
+#include <cstdint>
+#include <tuple>
+#include "TimeStamp.hh"
+
+namespace Analytical {
+/**
+ * Tie-break key of a scheduled event.
+ * Events sharing a time_stamp run in ascending key order, so that their
+ * order only depends on who issued them and when, not on the order they
+ * were added to an event-queue (which differs between the sequential and
+ * the parallel engine).
+ */
+struct EventKey {
+  /**
+   * time the event was issued (in ps)
+   */
+  TimeStamp issue_time = 0;
+
+  /**
+   * id of the issuing npu (-1: not issued by an npu)
+   */
+  int issuer = -1;
+
+  /**
+   * order of the event among the events of the issuer
+   * (32 bits keep a scheduled event in one cache line; wrapping around
+   * only reorders events of an issuer issued at the same time, and
+   * identically in every run)
+   */
+  uint32_t sequence = 0;
+
+  bool operator<(const EventKey& other) const noexcept {
+    return std::tie(issue_time, issuer, sequence) <
+        std::tie(other.issue_time, other.issuer, other.sequence);
+  }
+};
+} // namespace Analytical
+
+#endif
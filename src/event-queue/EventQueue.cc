@@ -4,73 +4,196 @@ LICENSE file in the root directory of this source tree.
 *******************************************************************************/
 
 #include "EventQueue.hh"
+#include "HeapEventScheduler.hh"
+#include "ListEventScheduler.hh"
 
-void Analytical::EventQueue::add_event(
-    AstraSim::timespec_t time_stamp,
+Analytical::EventQueue::EventQueue(SchedulerType scheduler_type) noexcept
+    : current_time_events(0) {
+  switch (scheduler_type) {
+    case SchedulerType::List:
+      scheduler = std::make_unique<ListEventScheduler>();
+      break;
+    case SchedulerType::Heap:
+      scheduler = std::make_unique<HeapEventScheduler>();
+      break;
+  }
+}
+
+Analytical::EventHandle Analytical::EventQueue::add_event(
+    TimeStamp time_stamp,
     void (*fun_ptr)(void*),
     void* fun_arg) noexcept {
-  // Event Queue is ordered by time_stamp in ascending order.
-  // 1. Search Event queue:
-  //      (1) if time_stamp is smaller, search next entry
-  //      (2) if time_stamp is equal, add event to that entry
-  //      (3) if time_stamp is larger, it means no entry matches time_stamp
-  //            -> insert new event queue element
-
-  // should assign event that happens later than current_time
-  assert(EventQueueEntry::compare_time_stamp(current_time, time_stamp) < 0);
-
-  for (auto it = event_queue.begin(); it != event_queue.end(); it++) {
-    auto time_stamp_compare_result =
-        EventQueueEntry::compare_time_stamp(it->get_time_stamp(), time_stamp);
-    // if time_stamp is smaller, do nothing
-    if (time_stamp_compare_result == 0) {
-      // equal time_stamp -> insert event here
-      it->add_event(fun_ptr, fun_arg);
-      return;
-    } else if (time_stamp_compare_result > 0) {
-      // entry's time stamp is larger -> no matching queue entry found
-      // insert new queue entry
-      auto new_queue_entry = event_queue.emplace(it, time_stamp);
-      new_queue_entry->add_event(fun_ptr, fun_arg);
-      return;
-    }
+  return add_event(time_stamp, Event(fun_ptr, fun_arg));
+}
+
+Analytical::EventHandle Analytical::EventQueue::add_event(
+    TimeStamp time_stamp,
+    const Event& event) noexcept {
+  return add_event(
+      time_stamp, event, {current_time, -1, unkeyed_events_count++});
+}
+
+Analytical::EventHandle Analytical::EventQueue::add_event(
+    TimeStamp time_stamp,
+    const Event& event,
+    const EventKey& key) noexcept {
+  // should not assign event that happens before current_time
+  assert(current_time <= time_stamp);
+
+  if (event.empty()) {
+    // nothing to run: an empty event would never be counted as run
+    return EventHandle();
+  }
+
+  if (time_stamp == current_time && current_time_started) {
+    // zero-delay event: no need to search the scheduler
+    auto generation = current_time_events.get_generation();
+    auto index = current_time_events.add_event(event, key);
+    return {&current_time_events, generation, index};
+  }
+
+  // Events with the same time_stamp share one EventQueueEntry
+  // and run in key order.
+  auto event_queue_entry = scheduler->find(time_stamp);
+  if (event_queue_entry == nullptr) {
+    // no matching entry: take a new one from the pool
+    event_queue_entry = event_queue_entry_pool.acquire(time_stamp);
+    scheduler->push(event_queue_entry);
   }
 
-  // flow falls here when
-  // (1) event queue was empty
-  // (2) given time_stamp is larger than largest entry
-  //      -> for both cases, create new entry at the end of the event_queue
-  event_queue.emplace_back(time_stamp);
-  event_queue.back().add_event(fun_ptr, fun_arg);
+  auto generation = event_queue_entry->get_generation();
+  auto index = event_queue_entry->add_event(event, key);
+  return {event_queue_entry, generation, index};
 }
 
-AstraSim::timespec_t Analytical::EventQueue::get_current_time() const noexcept {
+bool Analytical::EventQueue::is_pending(
+    const EventHandle& event_handle) const noexcept {
+  if (event_handle.entry == nullptr) {
+    return false;
+  }
+
+  return event_handle.entry->is_pending(
+      event_handle.index, event_handle.generation);
+}
+
+bool Analytical::EventQueue::cancel_event(
+    const EventHandle& event_handle) noexcept {
+  if (!is_pending(event_handle)) {
+    // event already ran or got cancelled
+    return false;
+  }
+
+  event_handle.entry->cancel_event(event_handle.index);
+
+  // the entry stays in the scheduler (and is reused if another event
+  // gets scheduled at its time_stamp) until it reaches the front
+  remove_cancelled_front_entries();
+  return true;
+}
+
+Analytical::EventHandle Analytical::EventQueue::reschedule_event(
+    const EventHandle& event_handle,
+    TimeStamp new_time_stamp) noexcept {
+  assert(
+      is_pending(event_handle) &&
+      "<EventQueue::reschedule_event> event is not pending");
+
+  auto event = event_handle.entry->get_event(event_handle.index);
+  auto key = event_handle.entry->get_key(event_handle.index);
+  cancel_event(event_handle);
+  return add_event(new_time_stamp, event, key);
+}
+
+Analytical::TimeStamp Analytical::EventQueue::next_event_time()
+    const noexcept {
+  assert(!empty() && "<EventQueue::next_event_time> event queue is empty");
+
+  if (!current_time_events.empty()) {
+    return current_time;
+  }
+
+  return scheduler->front()->get_time_stamp();
+}
+
+Analytical::TimeStamp Analytical::EventQueue::get_current_time()
+    const noexcept {
   return current_time;
 }
 
-void Analytical::EventQueue::proceed() noexcept {
-  auto& event_queue_entry = event_queue.front();
+int Analytical::EventQueue::proceed() noexcept {
+  // zero-delay events are pending: run them before proceeding current time
+  if (!current_time_events.empty()) {
+    return current_time_events.run_events();
+  }
+
+  // remove queue entry: events scheduled at the new current_time from now on
+  // go to current_time_events
+  auto event_queue_entry = scheduler->front();
+  scheduler->pop_front();
+  remove_cancelled_front_entries();
 
   // proceed current time
-  current_time = event_queue_entry.get_time_stamp();
+  current_time = event_queue_entry->get_time_stamp();
+  current_time_events.reset(current_time);
+  current_time_started = true;
+
+  // run events and recycle the queue entry
+  auto run_events_count = event_queue_entry->run_events_in_key_order();
+  event_queue_entry_pool.release(event_queue_entry);
+
+  // run zero-delay events scheduled by the events above
+  run_events_count += current_time_events.run_events();
+  return run_events_count;
+}
 
-  // run events
-  event_queue_entry.run_events();
+uint64_t Analytical::EventQueue::run_until(TimeStamp end_time) noexcept {
+  auto run_events_count = (uint64_t)0;
+  while (!empty() && next_event_time() < end_time) {
+    run_events_count += proceed();
+  }
+  return run_events_count;
+}
+
+uint64_t Analytical::EventQueue::advance_to(TimeStamp time) noexcept {
+  assert(
+      current_time <= time &&
+      "<EventQueue::advance_to> time is before current_time");
 
-  // remove queue entry
-  event_queue.pop_front();
+  auto run_events_count = run_until(time);
+  if (current_time < time) {
+    // events already scheduled at time have not started running
+    current_time = time;
+    current_time_events.reset(current_time);
+    current_time_started = false;
+  }
+  return run_events_count;
+}
+
+uint64_t Analytical::EventQueue::run_events(uint64_t events_count) noexcept {
+  auto run_events_count = (uint64_t)0;
+  while (!empty() && run_events_count < events_count) {
+    run_events_count += proceed();
+  }
+  return run_events_count;
 }
 
 bool Analytical::EventQueue::empty() const noexcept {
-  return event_queue.empty();
+  return current_time_events.empty() && scheduler->empty();
+}
+
+void Analytical::EventQueue::remove_cancelled_front_entries() noexcept {
+  while (!scheduler->empty() && scheduler->front()->empty()) {
+    auto event_queue_entry = scheduler->front();
+    scheduler->pop_front();
+    event_queue_entry_pool.release(event_queue_entry);
+  }
 }
 
 void Analytical::EventQueue::print() const noexcept {
   std::cout << "===== event-queue =====" << std::endl;
-  std::cout << "CurrentTime: " << current_time.time_val << std::endl
+  std::cout << "CurrentTime: " << current_time << " ps" << std::endl
             << std::endl;
-  for (const auto& event_queue_entry : event_queue) {
-    event_queue_entry.print();
-  }
+  current_time_events.print();
+  scheduler->print();
   std::cout << "======================" << std::endl << std::endl;
 }
@@ -7,44 +7,168 @@ LICENSE file in the root directory of this source tree.
 #define __EVENTQUEUE_HH__
 
 #include <cassert>
-#include <list>
+#include <memory>
 #include "Event.hh"
+#include "EventHandle.hh"
+#include "EventKey.hh"
 #include "EventQueueEntry.hh"
-#include "astra-sim/system/AstraNetworkAPI.hh"
+#include "EventQueueEntryPool.hh"
+#include "EventScheduler.hh"
+#include "TimeStamp.hh"
 
 namespace Analytical {
 class EventQueue {
  public:
+  /**
+   * Scheduler backend that orders EventQueueEntry by time_stamp.
+   *   - List: sorted list, linear-time insertion
+   *   - Heap: binary heap with time_stamp hash index, logarithmic insertion
+   */
+  enum class SchedulerType { List, Heap };
+
   /**
    * Create new event-queue.
+   *
+   * @param scheduler_type scheduler backend to use
    */
-  EventQueue() {
-    current_time.time_res = AstraSim::NS;
-    current_time.time_val = 0;
-  }
+  explicit EventQueue(
+      SchedulerType scheduler_type = SchedulerType::Heap) noexcept;
 
   /**
    * Add new event to the event-queue.
+   * An event scheduled at current_time (i.e., zero delay) bypasses the
+   * scheduler and runs before current_time proceeds.
    *
-   * @param time_stamp time_stamp for the event
+   * @param time_stamp time_stamp for the event (in ps)
    * @param fun_ptr pointer to the event handler
    * @param fun_arg pointer to the event handler argument
+   * @return handle to cancel or reschedule the event
    */
-  void add_event(
-      AstraSim::timespec_t time_stamp,
+  EventHandle add_event(
+      TimeStamp time_stamp,
       void (*fun_ptr)(void*),
       void* fun_arg) noexcept;
 
   /**
-   * Fetch next event_queue entry, proceed current_time, and run scheduled
-   * events.
+   * Add new event to the event-queue.
+   * (Callable events are stored inline: scheduling them never allocates.)
+   * An empty event is not scheduled.
+   * The event is keyed (current_time, no issuer, order of the unkeyed
+   * events added), so unkeyed events sharing a time_stamp run in the
+   * order they were added.
+   *
+   * @param time_stamp time_stamp for the event (in ps)
+   * @param event event handler
+   * @return handle to cancel or reschedule the event
+   *         (handle to no event if event is empty)
+   */
+  EventHandle add_event(TimeStamp time_stamp, const Event& event) noexcept;
+
+  /**
+   * Add new event to the event-queue, with a tie-break key.
+   * Events scheduled ahead of current_time that share a time_stamp run in
+   * ascending key order. Zero-delay events run in the order they were
+   * added, after them.
+   *
+   * @param time_stamp time_stamp for the event (in ps)
+   * @param event event handler
+   * @param key tie-break key of the event
+   * @return handle to cancel or reschedule the event
+   *         (handle to no event if event is empty)
+   */
+  EventHandle add_event(
+      TimeStamp time_stamp,
+      const Event& event,
+      const EventKey& key) noexcept;
+
+  /**
+   * Check whether an event is still waiting to run.
+   *
+   * @param event_handle handle returned by add_event
+   * @return true if the event has neither run nor been cancelled,
+   *         false otherwise
+   */
+  bool is_pending(const EventHandle& event_handle) const noexcept;
+
+  /**
+   * Cancel a scheduled event in O(1).
+   * The event is tombstoned in place and skipped when its time comes.
+   * Cancelling an event that already ran (or was cancelled) is a no-op.
+   *
+   * @param event_handle handle returned by add_event
+   * @return true if a pending event got cancelled, false otherwise
+   */
+  bool cancel_event(const EventHandle& event_handle) noexcept;
+
+  /**
+   * Move a pending event to another time_stamp, keeping its key.
+   * Assertion: the event should be pending.
+   *
+   * @param event_handle handle returned by add_event
+   * @param new_time_stamp new time_stamp for the event (in ps)
+   * @return handle to the rescheduled event (event_handle becomes stale)
+   */
+  EventHandle reschedule_event(
+      const EventHandle& event_handle,
+      TimeStamp new_time_stamp) noexcept;
+
+  /**
+   * If any event is scheduled at current_time, run them without proceeding
+   * current_time. Otherwise, fetch next event_queue entry, proceed
+   * current_time, and run scheduled events (including zero-delay events they
+   * schedule).
+   * @return number of events run
+   */
+  int proceed() noexcept;
+
+  /**
+   * Run every event scheduled before end_time
+   * (including events they schedule before end_time).
+   * current_time is left at the time of the last event run,
+   * so events can still be added before end_time afterwards.
+   * (Use advance_to to move current_time to end_time.)
+   *
+   * @param end_time time bound (in ps, exclusive)
+   * @return number of events run
+   */
+  uint64_t run_until(TimeStamp end_time) noexcept;
+
+  /**
+   * Run every event scheduled before time (as run_until), then move
+   * current_time to time: e.g., to a synchronization point of a lockstep
+   * co-simulation, so events are then added relative to it.
+   * Events already scheduled at time are left pending, and events added
+   * at time afterwards run after them.
+   * Assertion: time should not be before current_time.
+   *
+   * @param time new current_time (in ps)
+   * @return number of events run
+   */
+  uint64_t advance_to(TimeStamp time) noexcept;
+
+  /**
+   * Run at least events_count events, or until the event_queue is empty.
+   * Events sharing a time_stamp run together, so slightly more than
+   * events_count events may run.
+   *
+   * @param events_count number of events to run
+   * @return number of events run
    */
-  void proceed() noexcept;
+  uint64_t run_events(uint64_t events_count) noexcept;
+
+  /**
+   * Time of the next event proceed() would run.
+   * Assertion: event_queue should not be empty.
+   * @return current_time if zero-delay events are pending,
+   *         time_stamp of the earliest EventQueueEntry otherwise
+   */
+  TimeStamp next_event_time() const noexcept;
 
   /**
    * current_time getter
+   * @return current_time (in ps)
    */
-  AstraSim::timespec_t get_current_time() const noexcept;
+  TimeStamp get_current_time() const noexcept;
 
   /**
    * Check whether event_queue is empty.
@@ -61,14 +185,45 @@ class EventQueue {
 
  private:
   /**
-   * current_time
+   * current_time (in ps)
+   */
+  TimeStamp current_time = 0;
+
+  /**
+   * FIFO lane of events scheduled at current_time
+   */
+  EventQueueEntry current_time_events;
+
+  /**
+   * whether the events scheduled at current_time have started running:
+   * events added at current_time only bypass the scheduler (into
+   * current_time_events) from then on, as advance_to may move
+   * current_time before the events scheduled at it have run
+   */
+  bool current_time_started = true;
+
+  /**
+   * number of events added without a key
+   * (sequence of their keys)
+   */
+  uint32_t unkeyed_events_count = 0;
+
+  /**
+   * recycling pool every EventQueueEntry is taken from
+   */
+  EventQueueEntryPool event_queue_entry_pool;
+
+  /**
+   * scheduler backend that orders EventQueueEntry
    */
-  AstraSim::timespec_t current_time = AstraSim::timespec_t();
+  std::unique_ptr<EventScheduler> scheduler;
 
   /**
-   * event_queue list that holds events
+   * Recycle EventQueueEntry at the front of the scheduler
+   * whose events are all cancelled,
+   * so that the front entry always has an event to run.
    */
-  std::list<EventQueueEntry> event_queue;
+  void remove_cancelled_front_entries() noexcept;
 };
 } // namespace Analytical
 
@@ -5,44 +5,165 @@ LICENSE file in the root directory of this source tree.
 
 #include "EventQueueEntry.hh"
 
-int Analytical::EventQueueEntry::compare_time_stamp(
-    AstraSim::timespec_t time_stamp_a,
-    AstraSim::timespec_t time_stamp_b) noexcept {
-  // assumption: time_res is always NS
-  // FIXME: when using time_res other than NS.
+#include <algorithm>
+#include <cassert>
 
-  if (time_stamp_a.time_val < time_stamp_b.time_val) {
-    return -1;
+Analytical::TimeStamp Analytical::EventQueueEntry::get_time_stamp()
+    const noexcept {
+  return time_stamp;
+}
+
+uint64_t Analytical::EventQueueEntry::get_generation() const noexcept {
+  return generation;
+}
+
+void Analytical::EventQueueEntry::reset(TimeStamp new_time_stamp) noexcept {
+  assert(
+      pending_events_count == 0 &&
+      "<EventQueueEntry::reset> entry still has events to run");
+
+  // drop cancelled events left behind
+  if (events_count > 0) {
+    clear();
+  }
+
+  time_stamp = new_time_stamp;
+}
+
+int Analytical::EventQueueEntry::add_event(
+    const Event& event,
+    const EventKey& key) noexcept {
+  if (events_count > 0 && key < scheduled_event_at(events_count - 1).key) {
+    keys_sorted = false;
   }
 
-  if (time_stamp_a.time_val > time_stamp_b.time_val) {
-    return 1;
+  if (events_count < inline_events_capacity) {
+    inline_events[events_count] = {event, key};
+  } else {
+    overflow_events.push_back({event, key});
   }
 
-  return 0;
+  // an empty event is a tombstone run_events() skips: never pending
+  if (!event.empty()) {
+    pending_events_count++;
+  }
+  return events_count++;
 }
 
-AstraSim::timespec_t Analytical::EventQueueEntry::get_time_stamp()
+bool Analytical::EventQueueEntry::is_pending(int index, uint64_t generation)
     const noexcept {
-  return time_stamp;
+  return (generation == this->generation) && (next_run_index <= index) &&
+      (index < events_count) && !get_event(index).empty();
+}
+
+const Analytical::Event& Analytical::EventQueueEntry::get_event(int index)
+    const noexcept {
+  return scheduled_event_at(index).event;
+}
+
+const Analytical::EventKey& Analytical::EventQueueEntry::get_key(
+    int index) const noexcept {
+  return scheduled_event_at(index).key;
+}
+
+void Analytical::EventQueueEntry::cancel_event(int index) noexcept {
+  assert(
+      is_pending(index, generation) &&
+      "<EventQueueEntry::cancel_event> event is not pending");
+
+  // tombstone: run_events() skips empty events
+  event_at(index) = Event();
+  pending_events_count--;
 }
 
-void Analytical::EventQueueEntry::add_event(
-    void (*fun_ptr)(void*),
-    void* fun_arg) noexcept {
-  events.emplace_back(fun_ptr, fun_arg);
+bool Analytical::EventQueueEntry::empty() const noexcept {
+  return pending_events_count == 0;
 }
 
-void Analytical::EventQueueEntry::run_events() noexcept {
-  while (!events.empty()) {
-    auto event = events.front();
+int Analytical::EventQueueEntry::run_events() noexcept {
+  auto run_events_count = 0;
+
+  // an event handler may add new events to this entry, or cancel them:
+  // re-check events_count after running each event
+  while (next_run_index < events_count) {
+    auto event = get_event(next_run_index);
+    next_run_index++;
+
+    if (event.empty()) {
+      // cancelled event
+      continue;
+    }
+
+    pending_events_count--;
+    event.run();
+    run_events_count++;
+  }
+
+  clear();
+  return run_events_count;
+}
+
+int Analytical::EventQueueEntry::run_events_in_key_order() noexcept {
+  if (keys_sorted) {
+    // adding order is key order
+    return run_events();
+  }
+
+  // (events sharing a key keep their adding order)
+  run_order.clear();
+  for (auto index = 0; index < events_count; index++) {
+    run_order.emplace_back(get_key(index), index);
+  }
+  std::sort(run_order.begin(), run_order.end());
+
+  // an event handler may cancel events that have not run yet:
+  // empty each event before running it, so it is no longer pending
+  auto run_events_count = 0;
+  for (const auto& key_index : run_order) {
+    auto& slot = event_at(key_index.second);
+    if (slot.empty()) {
+      // cancelled event
+      continue;
+    }
+
+    auto event = slot;
+    slot = Event();
+    pending_events_count--;
     event.run();
-    events.pop_front();
+    run_events_count++;
   }
+
+  // then run events added meanwhile
+  next_run_index = (int)run_order.size();
+  return run_events_count + run_events();
 }
 
 void Analytical::EventQueueEntry::print() const noexcept {
   std::cout << "EventQueueEntry:" << std::endl;
-  std::cout << "\t- TimeStamp: " << (int)time_stamp.time_val << std::endl;
-  std::cout << "\t- #Events: " << events.size() << std::endl << std::endl;
+  std::cout << "\t- TimeStamp: " << time_stamp << " ps" << std::endl;
+  std::cout << "\t- #Events: " << pending_events_count << std::endl
+            << std::endl;
+}
+
+const Analytical::EventQueueEntry::ScheduledEvent& Analytical::
+    EventQueueEntry::scheduled_event_at(int index) const noexcept {
+  return (index < inline_events_capacity)
+      ? inline_events[index]
+      : overflow_events[index - inline_events_capacity];
+}
+
+Analytical::Event& Analytical::EventQueueEntry::event_at(int index) noexcept {
+  return (index < inline_events_capacity)
+      ? inline_events[index].event
+      : overflow_events[index - inline_events_capacity].event;
+}
+
+void Analytical::EventQueueEntry::clear() noexcept {
+  // keep overflow_events and run_order capacity for reuse
+  events_count = 0;
+  pending_events_count = 0;
+  next_run_index = 0;
+  keys_sorted = true;
+  overflow_events.clear();
+  generation++;
 }
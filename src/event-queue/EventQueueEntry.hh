@@ -6,10 +6,14 @@ LICENSE file in the root directory of this source tree.
 #ifndef __EVENTQUEUEENTRY_HH__
 #define __EVENTQUEUEENTRY_HH__
 
+#include <array>
+#include <cstdint>
 #include <iostream>
-#include <list>
+#include <utility>
+#include <vector>
 #include "Event.hh"
-#include "astra-sim/system/AstraNetworkAPI.hh"
+#include "EventKey.hh"
+#include "TimeStamp.hh"
 
 namespace Analytical {
 struct EventQueueEntry {
@@ -19,41 +23,96 @@ struct EventQueueEntry {
    *
    * @param time_stamp time_stamp of this EventQueueEntry.
    */
-  explicit EventQueueEntry(AstraSim::timespec_t time_stamp) noexcept
+  explicit EventQueueEntry(TimeStamp time_stamp) noexcept
       : time_stamp(time_stamp) {}
 
   /**
-   * Compare time_stamp_a and time_stamp_b.
-   *
-   * @param another_time_stamp
-   * @return (positive int) if time_stamp_a is latter
-   *         (negative int) if time_stamp_a is former
-   *         (0)            if equal
-   *         e.g., if time_stamp_a is (100ns) and time_stamp_b is (200ns),
-   *               this function returns (negative int).
+   * time_stamp getter
+   * @return time_stamp
    */
-  static int compare_time_stamp(
-      AstraSim::timespec_t time_stamp_a,
-      AstraSim::timespec_t time_stamp_b) noexcept;
+  TimeStamp get_time_stamp() const noexcept;
 
   /**
-   * time_stamp getter
-   * @return time_stamp
+   * generation getter
+   * (bumped whenever the events of this entry are cleared)
+   * @return generation
+   */
+  uint64_t get_generation() const noexcept;
+
+  /**
+   * Re-mark an empty EventQueueEntry with a new time_stamp,
+   * so that it can be recycled. Cancelled events left are cleared.
+   * Assertion: no pending event should be left in the entry.
+   *
+   * @param new_time_stamp new time_stamp of this EventQueueEntry
    */
-  AstraSim::timespec_t get_time_stamp() const noexcept;
+  void reset(TimeStamp new_time_stamp) noexcept;
 
   /**
    * Add an event handler.
+   * (An empty event is stored as a cancelled one: it is never pending.)
    *
-   * @param fun_ptr pointer to event handler
-   * @param fun_arg pointer to event handler argument
+   * @param event event handler
+   * @param key tie-break key of the event
+   * @return index of the event inside this entry
    */
-  void add_event(void (*fun_ptr)(void*), void* fun_arg) noexcept;
+  int add_event(const Event& event, const EventKey& key) noexcept;
 
   /**
-   * Run all events in `events` list and remove them from the list.
+   * Check whether an event is still waiting to run.
+   *
+   * @param index index of the event
+   * @param generation generation of the entry when the event was added
+   * @return true if the event has neither run nor been cancelled,
+   *         false otherwise
+   */
+  bool is_pending(int index, uint64_t generation) const noexcept;
+
+  /**
+   * Get a scheduled event.
+   *
+   * @param index index of the event
+   * @return event handler
+   */
+  const Event& get_event(int index) const noexcept;
+
+  /**
+   * Get the tie-break key of a scheduled event.
+   *
+   * @param index index of the event
+   * @return key of the event
    */
-  void run_events() noexcept;
+  const EventKey& get_key(int index) const noexcept;
+
+  /**
+   * Cancel a pending event: it is overwritten with an empty event,
+   * which run_events() skips.
+   * Assertion: the event should be pending.
+   *
+   * @param index index of the event
+   */
+  void cancel_event(int index) noexcept;
+
+  /**
+   * Check whether any pending event is scheduled in this entry.
+   * @return true if no pending event is scheduled, false otherwise
+   */
+  bool empty() const noexcept;
+
+  /**
+   * Run all pending events in the order they were added
+   * (including events added while running), and remove them.
+   * @return number of events run
+   */
+  int run_events() noexcept;
+
+  /**
+   * Run all pending events in ascending key order (stable), and remove
+   * them. Events added while running run afterwards, in the order they
+   * were added.
+   * @return number of events run
+   */
+  int run_events_in_key_order() noexcept;
 
   /**
    * (For debugging purpose)
@@ -62,15 +121,90 @@ struct EventQueueEntry {
   void print() const noexcept;
 
  private:
+  /**
+   * number of events stored inline, without any heap allocation
+   */
+  static constexpr int inline_events_capacity = 4;
+
   /**
    * time stamp of current EventQueueEntry.
    */
-  const AstraSim::timespec_t time_stamp;
+  TimeStamp time_stamp;
+
+  /**
+   * number of scheduled events (including cancelled ones).
+   */
+  int events_count = 0;
+
+  /**
+   * number of scheduled events not yet run nor cancelled.
+   */
+  int pending_events_count = 0;
+
+  /**
+   * index of the next event run_events() will run.
+   * (Events before it already ran: run_events() leaves them in place,
+   * while run_events_in_key_order() empties each event as it runs.)
+   */
+  int next_run_index = 0;
+
+  /**
+   * generation of the events stored in this entry.
+   */
+  uint64_t generation = 0;
+
+  /**
+   * whether the keys were added in ascending order
+   * (run_events_in_key_order() then needs no sorting).
+   */
+  bool keys_sorted = true;
+
+  /**
+   * A scheduled event, with its key.
+   */
+  struct ScheduledEvent {
+    Event event;
+    EventKey key;
+  };
+
+  /**
+   * first scheduled events, stored inline.
+   */
+  std::array<ScheduledEvent, inline_events_capacity> inline_events;
+
+  /**
+   * scheduled events beyond inline_events_capacity.
+   * (capacity is kept when the entry is recycled)
+   */
+  std::vector<ScheduledEvent> overflow_events;
+
+  /**
+   * (key, index) of the events, sorted by run_events_in_key_order().
+   * (capacity is kept when the entry is recycled)
+   */
+  std::vector<std::pair<EventKey, int>> run_order;
+
+  /**
+   * Get a scheduled event with its key.
+   *
+   * @param index index of the event
+   * @return scheduled event
+   */
+  const ScheduledEvent& scheduled_event_at(int index) const noexcept;
+
+  /**
+   * Get a mutable reference to a scheduled event.
+   *
+   * @param index index of the event
+   * @return event handler
+   */
+  Event& event_at(int index) noexcept;
 
   /**
-   * list of scheduled events.
+   * Remove all events and bump generation,
+   * so that handles to the removed events become stale.
    */
-  std::list<Event> events;
+  void clear() noexcept;
 };
 } // namespace Analytical
 
@@ -0,0 +1,30 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "EventQueueEntryPool.hh"
+
+Analytical::EventQueueEntry* Analytical::EventQueueEntryPool::acquire(
+    TimeStamp time_stamp) noexcept {
+  if (free_entries.empty()) {
+    // no entry to recycle: grow the arena
+    arena.emplace_back(time_stamp);
+    return &arena.back();
+  }
+
+  // recycle a released entry
+  auto entry = free_entries.back();
+  free_entries.pop_back();
+  entry->reset(time_stamp);
+  return entry;
+}
+
+void Analytical::EventQueueEntryPool::release(EventQueueEntry* entry) noexcept {
+  free_entries.emplace_back(entry);
+}
+
+size_t Analytical::EventQueueEntryPool::get_allocated_entries_count()
+    const noexcept {
+  return arena.size();
+}
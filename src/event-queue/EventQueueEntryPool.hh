@@ -0,0 +1,57 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __EVENTQUEUEENTRYPOOL_HH__
+#define __EVENTQUEUEENTRYPOOL_HH__
+
+#include <deque>
+#include <vector>
+#include "EventQueueEntry.hh"
+#include "TimeStamp.hh"
+
+namespace Analytical {
+/**
+ * Recycling arena of EventQueueEntry.
+ * Entries are never freed until the pool is destroyed:
+ * once the pool has grown to the peak number of pending time_stamps,
+ * acquiring and releasing entries does not touch the global allocator.
+ */
+class EventQueueEntryPool {
+ public:
+  /**
+   * Take an EventQueueEntry out of the pool, marked with given time_stamp.
+   *
+   * @param time_stamp time_stamp of the entry
+   * @return pointer to an empty EventQueueEntry
+   */
+  EventQueueEntry* acquire(TimeStamp time_stamp) noexcept;
+
+  /**
+   * Return an EventQueueEntry to the pool.
+   * entry should be acquired from this pool and have all its events run.
+   *
+   * @param entry entry to recycle
+   */
+  void release(EventQueueEntry* entry) noexcept;
+
+  /**
+   * @return the number of entries ever created by this pool
+   */
+  size_t get_allocated_entries_count() const noexcept;
+
+ private:
+  /**
+   * arena holding every entry (deque keeps addresses stable while growing)
+   */
+  std::deque<EventQueueEntry> arena;
+
+  /**
+   * entries ready to be reused
+   */
+  std::vector<EventQueueEntry*> free_entries;
+};
+} // namespace Analytical
+
+#endif
@@ -0,0 +1,63 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __EVENTSCHEDULER_HH__
+#define __EVENTSCHEDULER_HH__
+
+#include "EventQueueEntry.hh"
+#include "TimeStamp.hh"
+
+namespace Analytical {
+class EventScheduler {
+ public:
+  virtual ~EventScheduler() noexcept = default;
+
+  /**
+   * Find the EventQueueEntry marked with given time_stamp.
+   *
+   * @param time_stamp time_stamp to search
+   * @return EventQueueEntry marked with time_stamp,
+   *         nullptr if no such entry exists
+   */
+  virtual EventQueueEntry* find(TimeStamp time_stamp) const noexcept = 0;
+
+  /**
+   * Insert a new EventQueueEntry.
+   * The scheduler does not own the entry.
+   * Assertion: no entry with the same time_stamp should exist.
+   *
+   * @param entry entry to insert
+   */
+  virtual void push(EventQueueEntry* entry) noexcept = 0;
+
+  /**
+   * Return the EventQueueEntry with the smallest time_stamp.
+   * Assertion: scheduler should not be empty.
+   *
+   * @return earliest EventQueueEntry
+   */
+  virtual EventQueueEntry* front() const noexcept = 0;
+
+  /**
+   * Remove the EventQueueEntry with the smallest time_stamp.
+   * Assertion: scheduler should not be empty.
+   */
+  virtual void pop_front() noexcept = 0;
+
+  /**
+   * Check whether the scheduler holds any EventQueueEntry.
+   * @return true if empty, false otherwise
+   */
+  virtual bool empty() const noexcept = 0;
+
+  /**
+   * (For debugging purpose)
+   * Print all EventQueueEntry in the scheduler.
+   */
+  virtual void print() const noexcept = 0;
+};
+} // namespace Analytical
+
+#endif
@@ -0,0 +1,141 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "HeapEventScheduler.hh"
+
+#include <algorithm>
+#include <cassert>
+
+Analytical::HeapEventScheduler::HeapEventScheduler() noexcept
+    : index(initial_index_capacity, nullptr) {}
+
+bool Analytical::HeapEventScheduler::is_later(
+    const EventQueueEntry* entry_a,
+    const EventQueueEntry* entry_b) noexcept {
+  return entry_a->get_time_stamp() > entry_b->get_time_stamp();
+}
+
+size_t Analytical::HeapEventScheduler::index_slot(
+    TimeStamp time_stamp) const noexcept {
+  // splitmix64 finalizer
+  auto key = time_stamp;
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  key ^= key >> 31;
+
+  return key & (index.size() - 1);
+}
+
+void Analytical::HeapEventScheduler::index_insert(
+    EventQueueEntry* entry) noexcept {
+  // keep load factor below 1/2: grow before inserting
+  if ((heap.size() * 2) > index.size()) {
+    auto old_index = std::vector<EventQueueEntry*>(index.size() * 2, nullptr);
+    old_index.swap(index);
+    for (const auto old_entry : old_index) {
+      if (old_entry != nullptr) {
+        auto slot = index_slot(old_entry->get_time_stamp());
+        while (index[slot] != nullptr) {
+          slot = (slot + 1) & (index.size() - 1);
+        }
+        index[slot] = old_entry;
+      }
+    }
+  }
+
+  auto slot = index_slot(entry->get_time_stamp());
+  while (index[slot] != nullptr) {
+    slot = (slot + 1) & (index.size() - 1);
+  }
+  index[slot] = entry;
+}
+
+void Analytical::HeapEventScheduler::index_erase(
+    const EventQueueEntry* entry) noexcept {
+  auto mask = index.size() - 1;
+
+  // find the slot holding entry
+  auto slot = index_slot(entry->get_time_stamp());
+  while (index[slot] != entry) {
+    assert(
+        index[slot] != nullptr &&
+        "<HeapEventScheduler::index_erase> entry is not indexed");
+    slot = (slot + 1) & mask;
+  }
+
+  // backward-shift deletion: move following entries of the probe chain
+  // into the hole, so that no tombstone is required
+  auto hole = slot;
+  auto next = (hole + 1) & mask;
+  while (index[next] != nullptr) {
+    auto home = index_slot(index[next]->get_time_stamp());
+    // move index[next] only if its home slot is not within (hole, next]
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      index[hole] = index[next];
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+  index[hole] = nullptr;
+}
+
+Analytical::EventQueueEntry* Analytical::HeapEventScheduler::find(
+    TimeStamp time_stamp) const noexcept {
+  auto slot = index_slot(time_stamp);
+  while (index[slot] != nullptr) {
+    if (index[slot]->get_time_stamp() == time_stamp) {
+      return index[slot];
+    }
+    slot = (slot + 1) & (index.size() - 1);
+  }
+
+  // no entry with the same time_stamp
+  return nullptr;
+}
+
+void Analytical::HeapEventScheduler::push(EventQueueEntry* entry) noexcept {
+  assert(
+      find(entry->get_time_stamp()) == nullptr &&
+      "<HeapEventScheduler::push> Same time_stamp entry already exist.");
+
+  index_insert(entry);
+  heap.emplace_back(entry);
+  std::push_heap(heap.begin(), heap.end(), is_later);
+}
+
+Analytical::EventQueueEntry* Analytical::HeapEventScheduler::front()
+    const noexcept {
+  assert(!empty() && "<HeapEventScheduler::front> scheduler is empty");
+  return heap.front();
+}
+
+void Analytical::HeapEventScheduler::pop_front() noexcept {
+  assert(!empty() && "<HeapEventScheduler::pop_front> scheduler is empty");
+
+  index_erase(heap.front());
+  std::pop_heap(heap.begin(), heap.end(), is_later);
+  heap.pop_back();
+}
+
+bool Analytical::HeapEventScheduler::empty() const noexcept {
+  return heap.empty();
+}
+
+void Analytical::HeapEventScheduler::print() const noexcept {
+  // heap is not sorted: print entries in time_stamp order
+  auto entries = heap;
+  std::sort(
+      entries.begin(),
+      entries.end(),
+      [](const EventQueueEntry* entry_a, const EventQueueEntry* entry_b) {
+        return entry_a->get_time_stamp() < entry_b->get_time_stamp();
+      });
+
+  for (const auto entry : entries) {
+    entry->print();
+  }
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __HEAPEVENTSCHEDULER_HH__
+#define __HEAPEVENTSCHEDULER_HH__
+
+#include <cstdint>
+#include <vector>
+#include "EventQueueEntry.hh"
+#include "EventScheduler.hh"
+#include "TimeStamp.hh"
+
+namespace Analytical {
+/**
+ * EventScheduler keeping EventQueueEntry in a binary min-heap,
+ * with a time_stamp -> EventQueueEntry hash index on the side.
+ *   - adding an event to an existing time_stamp: O(1)
+ *   - adding an event with a new time_stamp: O(log n)
+ *   - popping the earliest EventQueueEntry: O(log n)
+ * Both the heap and the index are flat arrays, so no allocation happens
+ * once they have grown to the peak number of pending time_stamps.
+ */
+class HeapEventScheduler : public EventScheduler {
+ public:
+  HeapEventScheduler() noexcept;
+
+  EventQueueEntry* find(TimeStamp time_stamp) const noexcept override;
+
+  void push(EventQueueEntry* entry) noexcept override;
+
+  EventQueueEntry* front() const noexcept override;
+
+  void pop_front() noexcept override;
+
+  bool empty() const noexcept override;
+
+  void print() const noexcept override;
+
+ private:
+  /**
+   * initial number of index slots (should be power of 2)
+   */
+  static constexpr size_t initial_index_capacity = 64;
+
+  /**
+   * Heap ordering: true if entry_a should be placed below entry_b,
+   * i.e., entry_a has the larger time_stamp.
+   */
+  static bool is_later(
+      const EventQueueEntry* entry_a,
+      const EventQueueEntry* entry_b) noexcept;
+
+  /**
+   * Compute the home slot of given time_stamp in the index.
+   * @param time_stamp
+   * @return slot index
+   */
+  size_t index_slot(TimeStamp time_stamp) const noexcept;
+
+  /**
+   * Insert an entry into the index.
+   * @param entry
+   */
+  void index_insert(EventQueueEntry* entry) noexcept;
+
+  /**
+   * Remove an entry from the index.
+   * @param entry
+   */
+  void index_erase(const EventQueueEntry* entry) noexcept;
+
+  /**
+   * binary min-heap of EventQueueEntry, ordered by time_stamp
+   */
+  std::vector<EventQueueEntry*> heap;
+
+  /**
+   * open-addressing (linear probing) time_stamp -> EventQueueEntry index.
+   * empty slot holds nullptr.
+   */
+  std::vector<EventQueueEntry*> index;
+};
+} // namespace Analytical
+
+#endif
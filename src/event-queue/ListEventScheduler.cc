@@ -0,0 +1,70 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "ListEventScheduler.hh"
+
+#include <cassert>
+
+Analytical::EventQueueEntry* Analytical::ListEventScheduler::find(
+    TimeStamp time_stamp) const noexcept {
+  // Event Queue is ordered by time_stamp in ascending order.
+  // Search Event queue:
+  //      (1) if time_stamp is smaller, search next entry
+  //      (2) if time_stamp is equal, return that entry
+  //      (3) if time_stamp is larger, it means no entry matches time_stamp
+  for (const auto entry : event_queue) {
+    // if time_stamp is smaller, do nothing
+    if (entry->get_time_stamp() == time_stamp) {
+      // equal time_stamp -> found
+      return entry;
+    } else if (entry->get_time_stamp() > time_stamp) {
+      // entry's time stamp is larger -> no matching queue entry found
+      return nullptr;
+    }
+  }
+
+  // event queue was empty or time_stamp is larger than the largest entry
+  return nullptr;
+}
+
+void Analytical::ListEventScheduler::push(EventQueueEntry* entry) noexcept {
+  // insert before the first entry with a larger time_stamp
+  for (auto it = event_queue.begin(); it != event_queue.end(); it++) {
+    assert(
+        (*it)->get_time_stamp() != entry->get_time_stamp() &&
+        "<ListEventScheduler::push> Same time_stamp entry already exist.");
+    if ((*it)->get_time_stamp() > entry->get_time_stamp()) {
+      event_queue.insert(it, entry);
+      return;
+    }
+  }
+
+  // flow falls here when
+  // (1) event queue was empty
+  // (2) given time_stamp is larger than largest entry
+  //      -> for both cases, insert the entry at the end of the event_queue
+  event_queue.emplace_back(entry);
+}
+
+Analytical::EventQueueEntry* Analytical::ListEventScheduler::front()
+    const noexcept {
+  assert(!empty() && "<ListEventScheduler::front> scheduler is empty");
+  return event_queue.front();
+}
+
+void Analytical::ListEventScheduler::pop_front() noexcept {
+  assert(!empty() && "<ListEventScheduler::pop_front> scheduler is empty");
+  event_queue.pop_front();
+}
+
+bool Analytical::ListEventScheduler::empty() const noexcept {
+  return event_queue.empty();
+}
+
+void Analytical::ListEventScheduler::print() const noexcept {
+  for (const auto entry : event_queue) {
+    entry->print();
+  }
+}
@@ -0,0 +1,41 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __LISTEVENTSCHEDULER_HH__
+#define __LISTEVENTSCHEDULER_HH__
+
+#include <list>
+#include "EventQueueEntry.hh"
+#include "EventScheduler.hh"
+#include "TimeStamp.hh"
+
+namespace Analytical {
+/**
+ * EventScheduler keeping EventQueueEntry in a sorted list.
+ * Insertion takes linear time in the number of pending time_stamps.
+ */
+class ListEventScheduler : public EventScheduler {
+ public:
+  EventQueueEntry* find(TimeStamp time_stamp) const noexcept override;
+
+  void push(EventQueueEntry* entry) noexcept override;
+
+  EventQueueEntry* front() const noexcept override;
+
+  void pop_front() noexcept override;
+
+  bool empty() const noexcept override;
+
+  void print() const noexcept override;
+
+ private:
+  /**
+   * EventQueueEntry list ordered by time_stamp in ascending order.
+   */
+  std::list<EventQueueEntry*> event_queue;
+};
+} // namespace Analytical
+
+#endif
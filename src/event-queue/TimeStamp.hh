@@ -0,0 +1,19 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __TIMESTAMP_HH__
+#define __TIMESTAMP_HH__
+
+#include <cstdint>
+
+namespace Analytical {
+/**
+ * Simulated time (or duration) in integer picoseconds.
+ * 64 bits cover ~213 days of simulated time without overflow.
+ */
+using TimeStamp = uint64_t;
+} // namespace Analytical
+
+#endif
@@ -0,0 +1,428 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "FlowNetwork.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+
+namespace {
+/**
+ * @param a fair share or rate (in B/ns), possibly infinity
+ * @param b fair share or rate (in B/ns), possibly infinity
+ * @return whether a and b only differ by rounding errors
+ */
+bool is_same_share(
+    Analytical::FlowNetwork::Bandwidth a,
+    Analytical::FlowNetwork::Bandwidth b) noexcept {
+  if (a == b) {
+    return true;
+  }
+  if (std::isinf(a) || std::isinf(b)) {
+    return false;
+  }
+  return std::abs(a - b) <= 1e-9 * std::max(a, b);
+}
+} // namespace
+
+Analytical::FlowNetwork::FlowNetwork(
+    std::shared_ptr<EventQueue> event_queue,
+    std::shared_ptr<Topology> topology) noexcept
+    : event_queue(std::move(event_queue)), topology(std::move(topology)) {}
+
+Analytical::TimeStamp Analytical::FlowNetwork::start_flow(
+    const std::vector<LinkId>& path,
+    double flow_size,
+    const Event& on_drained) noexcept {
+  assert(!path.empty() && "<FlowNetwork::start_flow> flow without any link");
+
+  auto flow = acquire_flow();
+  auto bottleneck_capacity = std::numeric_limits<Bandwidth>::max();
+  for (auto link_id : path) {
+    auto link = find_link(link_id);
+    links[link].flows.push_back(flow);
+    flows[flow].links.push_back(link);
+    bottleneck_capacity = std::min(bottleneck_capacity, links[link].capacity);
+  }
+
+  auto& new_flow = flows[flow];
+  new_flow.remaining_size = flow_size;
+  new_flow.rate = 0;
+  new_flow.next_rate = 0;
+  new_flow.last_update_time = event_queue->get_current_time();
+  new_flow.drain_event = EventHandle();
+  new_flow.on_drained = on_drained;
+  active_flows_count++;
+
+  // the new flow takes its share from the flows it meets
+  // (and gets a rate even if no fair share changes)
+  new_flow.changed = true;
+  changed_flows.push_back(flow);
+  seed_links.assign(new_flow.links.begin(), new_flow.links.end());
+  recompute_rates(seed_links);
+
+  return TopologyConfiguration::transferTime(flow_size, bottleneck_capacity);
+}
+
+size_t Analytical::FlowNetwork::get_active_flows_count() const noexcept {
+  return active_flows_count;
+}
+
+uint64_t Analytical::FlowNetwork::get_rate_updates_count() const noexcept {
+  return rate_updates_count;
+}
+
+uint64_t Analytical::FlowNetwork::get_link_updates_count() const noexcept {
+  return link_updates_count;
+}
+
+uint64_t Analytical::FlowNetwork::get_refills_count() const noexcept {
+  return refills_count;
+}
+
+uint32_t Analytical::FlowNetwork::find_link(LinkId link_id) noexcept {
+  auto link_index = link_indices.find(link_id);
+  if (link_index != link_indices.end()) {
+    return link_index->second;
+  }
+
+  // first flow passing this link
+  auto link = (uint32_t)links.size();
+  links.emplace_back();
+  links.back().capacity = topology->linkBandwidth(link_id);
+  links.back().fair_share = std::numeric_limits<Bandwidth>::infinity();
+  assert(
+      links.back().capacity > 0 &&
+      "<FlowNetwork::find_link> link bandwidth should be positive");
+  link_indices.emplace(link_id, link);
+  return link;
+}
+
+uint32_t Analytical::FlowNetwork::acquire_flow() noexcept {
+  if (free_flows.empty()) {
+    flows.emplace_back();
+    return (uint32_t)(flows.size() - 1);
+  }
+
+  auto flow = free_flows.back();
+  free_flows.pop_back();
+  return flow;
+}
+
+void Analytical::FlowNetwork::drain(uint32_t flow) noexcept {
+  auto& drained_flow = flows[flow];
+
+  // remove the flow from its links
+  // (its links vector keeps its capacity for the next flow of the pool)
+  seed_links.assign(drained_flow.links.begin(), drained_flow.links.end());
+  drained_flow.links.clear();
+  for (auto link : seed_links) {
+    auto& link_flows = links[link].flows;
+    auto position = std::find(link_flows.begin(), link_flows.end(), flow);
+    assert(
+        position != link_flows.end() &&
+        "<FlowNetwork::drain> flow is not on its link");
+    *position = link_flows.back();
+    link_flows.pop_back();
+  }
+
+  auto on_drained = drained_flow.on_drained;
+  drained_flow.drain_event = EventHandle();
+  drained_flow.on_drained = Event();
+  free_flows.push_back(flow);
+  active_flows_count--;
+
+  // the flows it met share the bandwidth it leaves
+  recompute_rates(seed_links);
+
+  on_drained.run();
+}
+
+void Analytical::FlowNetwork::recompute_rates(
+    const std::vector<uint32_t>& seed_links) noexcept {
+  for (auto link : seed_links) {
+    if (!links[link].queued) {
+      links[link].queued = true;
+      queued_links.push_back(link);
+    }
+  }
+
+  // fair share updates allowed before falling back to progressive filling
+  auto link_updates_left = (4 * links.size()) + 16;
+
+  while (queue_head < queued_links.size()) {
+    auto link = queued_links[queue_head];
+    queue_head++;
+    links[link].queued = false;
+
+    if (link_updates_left == 0) {
+      // propagation does not settle quickly: refill the component instead
+      for (auto i = queue_head; i < queued_links.size(); i++) {
+        links[queued_links[i]].queued = false;
+      }
+      queued_links.clear();
+      queue_head = 0;
+      for (auto flow : changed_flows) {
+        flows[flow].changed = false;
+      }
+      changed_flows.clear();
+      refill_rates(seed_links);
+      return;
+    }
+    link_updates_left--;
+    link_updates_count++;
+
+    auto fair_share = compute_fair_share(link);
+    if (is_same_share(fair_share, links[link].fair_share)) {
+      continue;
+    }
+    links[link].fair_share = fair_share;
+
+    // flows whose rate changes change the demand on their other links
+    for (auto flow : links[link].flows) {
+      auto& affected_flow = flows[flow];
+      auto next_rate = path_fair_share(flow);
+      if (is_same_share(next_rate, affected_flow.next_rate)) {
+        continue;
+      }
+      affected_flow.next_rate = next_rate;
+      if (!affected_flow.changed) {
+        affected_flow.changed = true;
+        changed_flows.push_back(flow);
+      }
+      for (auto passed_link : affected_flow.links) {
+        if (passed_link != link && !links[passed_link].queued) {
+          links[passed_link].queued = true;
+          queued_links.push_back(passed_link);
+        }
+      }
+    }
+  }
+  queued_links.clear();
+  queue_head = 0;
+
+  // fair shares are settled
+  for (auto flow : changed_flows) {
+    flows[flow].changed = false;
+    update_rate(flow, path_fair_share(flow));
+  }
+  changed_flows.clear();
+}
+
+Analytical::FlowNetwork::Bandwidth
+Analytical::FlowNetwork::compute_fair_share(uint32_t link) noexcept {
+  const auto& link_state = links[link];
+
+  // rate each flow could get on its other links
+  demands.clear();
+  for (auto flow : link_state.flows) {
+    auto demand = std::numeric_limits<Bandwidth>::infinity();
+    for (auto passed_link : flows[flow].links) {
+      if (passed_link != link) {
+        demand = std::min(demand, links[passed_link].fair_share);
+      }
+    }
+    demands.push_back(demand);
+  }
+  std::sort(demands.begin(), demands.end());
+
+  // flows demanding less than an equal split keep their demand,
+  // and the others split what is left
+  auto remaining_capacity = link_state.capacity;
+  auto flows_count = demands.size();
+  for (auto demand : demands) {
+    if (demand * flows_count >= remaining_capacity) {
+      return remaining_capacity / flows_count;
+    }
+    remaining_capacity -= demand;
+    flows_count--;
+  }
+
+  // every flow is limited elsewhere
+  return std::numeric_limits<Bandwidth>::infinity();
+}
+
+Analytical::FlowNetwork::Bandwidth Analytical::FlowNetwork::path_fair_share(
+    uint32_t flow) const noexcept {
+  auto fair_share = std::numeric_limits<Bandwidth>::infinity();
+  for (auto link : flows[flow].links) {
+    fair_share = std::min(fair_share, links[link].fair_share);
+  }
+  return fair_share;
+}
+
+Analytical::FlowNetwork::Bandwidth Analytical::FlowNetwork::guaranteed_rate(
+    uint32_t flow) const noexcept {
+  auto rate = std::numeric_limits<Bandwidth>::infinity();
+  for (auto link : flows[flow].links) {
+    const auto& link_state = links[link];
+    rate = std::min(rate, link_state.capacity / link_state.flows.size());
+  }
+  return rate;
+}
+
+void Analytical::FlowNetwork::refill_rates(
+    const std::vector<uint32_t>& seed_links) noexcept {
+  refills_count++;
+  collect_component(seed_links);
+
+  // progressive filling: repeatedly saturate the link with the smallest
+  // fair share, fixing the rate of its remaining flows to that share
+  typedef std::tuple<Bandwidth, uint32_t, uint64_t> Share;
+  auto shares =
+      std::priority_queue<Share, std::vector<Share>, std::greater<Share>>();
+
+  for (auto link : component_links) {
+    auto& link_state = links[link];
+    link_state.remaining_capacity = link_state.capacity;
+    link_state.unfrozen_flows_count = (int)link_state.flows.size();
+    link_state.version++;
+    if (link_state.unfrozen_flows_count > 0) {
+      shares.emplace(
+          link_state.remaining_capacity / link_state.unfrozen_flows_count,
+          link,
+          link_state.version);
+    }
+  }
+
+  while (!shares.empty()) {
+    auto link = std::get<1>(shares.top());
+    auto version = std::get<2>(shares.top());
+    shares.pop();
+
+    const auto& bottleneck = links[link];
+    if (version != bottleneck.version ||
+        bottleneck.unfrozen_flows_count == 0) {
+      // stale share
+      continue;
+    }
+
+    auto share = std::max(
+        bottleneck.remaining_capacity / bottleneck.unfrozen_flows_count,
+        0.0);
+    for (auto flow : bottleneck.flows) {
+      if (flows[flow].frozen) {
+        continue;
+      }
+      flows[flow].frozen = true;
+      update_rate(flow, share);
+
+      // the flow consumes its share on every link it passes
+      for (auto passed_link : flows[flow].links) {
+        auto& link_state = links[passed_link];
+        link_state.remaining_capacity -= share;
+        link_state.unfrozen_flows_count--;
+        link_state.version++;
+        if (link_state.unfrozen_flows_count > 0) {
+          shares.emplace(
+              std::max(link_state.remaining_capacity, 0.0) /
+                  link_state.unfrozen_flows_count,
+              passed_link,
+              link_state.version);
+        }
+      }
+    }
+  }
+
+  // fair share of a saturated link: the largest rate of its flows
+  for (auto link : component_links) {
+    auto& link_state = links[link];
+    link_state.fair_share = std::numeric_limits<Bandwidth>::infinity();
+    if (link_state.flows.empty() ||
+        link_state.remaining_capacity > 1e-9 * link_state.capacity) {
+      continue;
+    }
+    link_state.fair_share = 0;
+    for (auto flow : link_state.flows) {
+      link_state.fair_share =
+          std::max(link_state.fair_share, flows[flow].rate);
+    }
+  }
+
+  // reset scratch flags
+  for (auto flow : component_flows) {
+    flows[flow].visited = false;
+    flows[flow].frozen = false;
+  }
+  for (auto link : component_links) {
+    links[link].visited = false;
+  }
+}
+
+void Analytical::FlowNetwork::collect_component(
+    const std::vector<uint32_t>& seed_links) noexcept {
+  component_flows.clear();
+  component_links.clear();
+
+  for (auto link : seed_links) {
+    if (!links[link].visited) {
+      links[link].visited = true;
+      component_links.push_back(link);
+    }
+  }
+
+  // breadth-first search over links and the flows sharing them
+  for (auto i = (size_t)0; i < component_links.size(); i++) {
+    for (auto flow : links[component_links[i]].flows) {
+      if (flows[flow].visited) {
+        continue;
+      }
+      flows[flow].visited = true;
+      component_flows.push_back(flow);
+
+      for (auto link : flows[flow].links) {
+        if (!links[link].visited) {
+          links[link].visited = true;
+          component_links.push_back(link);
+        }
+      }
+    }
+  }
+}
+
+void Analytical::FlowNetwork::update_rate(
+    uint32_t flow,
+    Bandwidth rate) noexcept {
+  auto& updated_flow = flows[flow];
+  auto current_time = event_queue->get_current_time();
+
+  // bytes transferred since the last update (rate is in B/ns)
+  auto elapsed_ns = (current_time - updated_flow.last_update_time) / 1000.0;
+  updated_flow.remaining_size = std::max(
+      updated_flow.remaining_size - (updated_flow.rate * elapsed_ns), 0.0);
+  updated_flow.last_update_time = current_time;
+
+  // never below the guaranteed rate (e.g., a share rounded down to 0)
+  rate = std::max(rate, guaranteed_rate(flow));
+  updated_flow.next_rate = rate;
+  if (rate == updated_flow.rate &&
+      event_queue->is_pending(updated_flow.drain_event)) {
+    // drain time is unchanged
+    return;
+  }
+
+  assert(
+      (rate > 0 && std::isfinite(rate)) &&
+      "<FlowNetwork::update_rate> flow got no finite bandwidth");
+  updated_flow.rate = rate;
+  rate_updates_count++;
+
+  auto drain_time = current_time +
+      TopologyConfiguration::transferTime(updated_flow.remaining_size, rate);
+  if (event_queue->is_pending(updated_flow.drain_event)) {
+    updated_flow.drain_event =
+        event_queue->reschedule_event(updated_flow.drain_event, drain_time);
+  } else {
+    updated_flow.drain_event =
+        event_queue->add_event(drain_time, Event([this, flow]() {
+                                 drain(flow);
+                               }));
+  }
+}
@@ -0,0 +1,237 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __FLOWNETWORK_HH__
+#define __FLOWNETWORK_HH__
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "../event-queue/Event.hh"
+#include "../event-queue/EventHandle.hh"
+#include "../event-queue/EventQueue.hh"
+#include "../event-queue/TimeStamp.hh"
+#include "../topology/Topology.hh"
+
+namespace Analytical {
+/**
+ * Flow-level (fluid) model of messages sharing links.
+ *
+ * Each message in flight is a flow over the links of its path, and the
+ * bandwidth of each link is shared max-min fairly among the flows crossing
+ * it. Each link keeps its fair share (water level): flows limited
+ * elsewhere keep their rate, and the others split the remaining capacity
+ * equally. A flow runs at the smallest fair share along its path.
+ *
+ * Rates only change when a flow starts or drains. The fair shares of its
+ * links are then recomputed, and a change only propagates to the flows
+ * whose rate changes, and on to their other links, until no fair share
+ * changes: unaffected flows (even sharing links) keep their rates and
+ * drain events. If the propagation goes on for longer than refilling every
+ * link would take, rates are instead recomputed by progressive filling
+ * over the connected component of the flow.
+ * The drain event of each flow whose rate changed is rescheduled in the
+ * event queue.
+ */
+class FlowNetwork {
+ public:
+  using LinkId = Topology::LinkId;
+  using Bandwidth = Topology::Bandwidth;
+
+  /**
+   * Construct a flow network.
+   * @param event_queue event queue drain events are scheduled into
+   * @param topology topology the links of flows belong to
+   */
+  FlowNetwork(
+      std::shared_ptr<EventQueue> event_queue,
+      std::shared_ptr<Topology> topology) noexcept;
+
+  /**
+   * Start a flow at the current time.
+   * @param path links passed by the flow (should not be empty)
+   * @param flow_size number of bytes to transfer (wire size, with framing)
+   * @param on_drained event run once every byte has passed
+   * @return transfer time (in ps) of the flow if it were alone on its path
+   */
+  TimeStamp start_flow(
+      const std::vector<LinkId>& path,
+      double flow_size,
+      const Event& on_drained) noexcept;
+
+  /**
+   * @return number of flows in flight
+   */
+  size_t get_active_flows_count() const noexcept;
+
+  /**
+   * @return number of flow rate updates so far
+   */
+  uint64_t get_rate_updates_count() const noexcept;
+
+  /**
+   * @return number of fair share recomputations of a link so far
+   */
+  uint64_t get_link_updates_count() const noexcept;
+
+  /**
+   * @return number of rate recomputations falling back to progressive
+   *         filling so far
+   */
+  uint64_t get_refills_count() const noexcept;
+
+ private:
+  /**
+   * A flow in flight.
+   */
+  struct Flow {
+    std::vector<uint32_t> links; // indices of the links passed
+    double remaining_size = 0; // bytes not transferred yet
+    Bandwidth rate = 0; // current rate (in B/ns)
+    Bandwidth next_rate = 0; // (scratch) rate once propagation ends
+    bool changed = false; // (scratch) next_rate differs from rate
+    TimeStamp last_update_time = 0; // time remaining_size was updated
+    EventHandle drain_event; // drain event in the event queue
+    Event on_drained;
+    bool visited = false; // (scratch) reached by the component search
+    bool frozen = false; // (scratch) rate fixed by progressive filling
+  };
+
+  /**
+   * A link passed by at least one flow so far.
+   */
+  struct LinkState {
+    Bandwidth capacity = 0; // link bandwidth after line coding (in B/ns)
+    std::vector<uint32_t> flows; // indices of the flows passing the link
+    Bandwidth fair_share = 0; // water level, infinity if not saturated
+    bool queued = false; // (scratch) waiting in the propagation queue
+    bool visited = false; // (scratch) reached by the component search
+    Bandwidth remaining_capacity = 0; // (scratch) progressive filling
+    int unfrozen_flows_count = 0; // (scratch) progressive filling
+    uint64_t version = 0; // (scratch) invalidates stale heap entries
+  };
+
+  /**
+   * Find the state of a link, creating it on first use.
+   * @param link_id
+   * @return link index
+   */
+  uint32_t find_link(LinkId link_id) noexcept;
+
+  /**
+   * Take a flow from the flow pool.
+   * @return flow index
+   */
+  uint32_t acquire_flow() noexcept;
+
+  /**
+   * Handle the drain of a flow: remove it, then recompute the rates of
+   * the flows it shared links with.
+   * @param flow flow index
+   */
+  void drain(uint32_t flow) noexcept;
+
+  /**
+   * Recompute max-min fair rates after the flows of the given links
+   * changed, propagating fair share changes to the flows they affect,
+   * and reschedule the drain events of updated flows.
+   * @param seed_links link indices
+   */
+  void recompute_rates(const std::vector<uint32_t>& seed_links) noexcept;
+
+  /**
+   * Recompute max-min fair rates by progressive filling over the connected
+   * component(s) of the given links, and their fair shares.
+   * @param seed_links link indices
+   */
+  void refill_rates(const std::vector<uint32_t>& seed_links) noexcept;
+
+  /**
+   * Compute the fair share of a link from the rates its flows could get
+   * on their other links (i.e., the smallest fair share among them).
+   * @param link link index
+   * @return fair share (in B/ns), infinity if the link is not saturated
+   */
+  Bandwidth compute_fair_share(uint32_t link) noexcept;
+
+  /**
+   * @param flow flow index
+   * @return smallest fair share along the path of the flow
+   */
+  Bandwidth path_fair_share(uint32_t flow) const noexcept;
+
+  /**
+   * Max-min fairness gives each flow at least the capacity of one of its
+   * links divided by the flows passing it: used as a floor, so rounding
+   * errors never leave a flow without bandwidth.
+   * @param flow flow index
+   * @return smallest capacity per flow along the path of the flow
+   */
+  Bandwidth guaranteed_rate(uint32_t flow) const noexcept;
+
+  /**
+   * Collect the flows and links connected to the seed links into
+   * component_flows and component_links.
+   * @param seed_links link indices
+   */
+  void collect_component(const std::vector<uint32_t>& seed_links) noexcept;
+
+  /**
+   * Set the rate of a flow (after accounting for the bytes transferred
+   * since its last update), and reschedule its drain event.
+   * The rate is raised to the guaranteed rate of the flow if lower.
+   * @param flow flow index
+   * @param rate new rate (in B/ns)
+   */
+  void update_rate(uint32_t flow, Bandwidth rate) noexcept;
+
+  std::shared_ptr<EventQueue> event_queue;
+  std::shared_ptr<Topology> topology;
+
+  /**
+   * pool of flows, and indices of the free ones
+   */
+  std::vector<Flow> flows;
+  std::vector<uint32_t> free_flows;
+
+  /**
+   * links used so far, and their index by link id
+   */
+  std::vector<LinkState> links;
+  std::unordered_map<LinkId, uint32_t> link_indices;
+
+  /**
+   * (scratch) links whose flows changed, seeding the recomputation
+   */
+  std::vector<uint32_t> seed_links;
+
+  /**
+   * (scratch) links whose fair share should be recomputed, from
+   * queue_head on, and flows whose rate changed during propagation
+   */
+  std::vector<uint32_t> queued_links;
+  size_t queue_head = 0;
+  std::vector<uint32_t> changed_flows;
+
+  /**
+   * (scratch) rates flows could get on their other links
+   */
+  std::vector<Bandwidth> demands;
+
+  /**
+   * (scratch) connected component being recomputed
+   */
+  std::vector<uint32_t> component_flows;
+  std::vector<uint32_t> component_links;
+
+  size_t active_flows_count = 0;
+  uint64_t rate_updates_count = 0;
+  uint64_t link_updates_count = 0;
+  uint64_t refills_count = 0;
+};
+} // namespace Analytical
+
+#endif
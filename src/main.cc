@@ -3,6 +3,7 @@ This source code is licensed under the MIT license found in the
 LICENSE file in the root directory of this source tree.
 *******************************************************************************/
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
@@ -10,12 +11,15 @@ LICENSE file in the root directory of this source tree.
 #include <iostream>
 #include <memory>
 #include "api/AnalyticalNetwork.hh"
+#include "api/SendRecvWatchdog.hh"
 #include "astra-sim/system/Sys.hh"
 #include "astra-sim/system/memory/SimpleMemory.hh"
 #include "event-queue/EventQueue.hh"
 #include "event-queue/EventQueueEntry.hh"
+#include "flow/FlowNetwork.hh"
 #include "helper/CommandLineParser.hh"
 #include "helper/json.hh"
+#include "parallel/ParallelEngine.hh"
 #include "topology/AllToAll.hh"
 #include "topology/Ring.hh"
 #include "topology/Switch.hh"
@@ -55,6 +59,21 @@ int main(int argc, char* argv[]) {
       "stat-row", "Index of current run (index starts with 0)");
   cmd_parser.add_command_line_option<bool>(
       "rendezvous-protocol", "Whether to enable rendezvous protocol");
+  cmd_parser.add_command_line_option<std::string>(
+      "event-queue-scheduler", "Event queue scheduler backend (Heap or List)");
+  cmd_parser.add_command_line_option<int>(
+      "threads-count",
+      "Number of threads simulating the network (events run in the same "
+      "order as with 1 thread)");
+  cmd_parser.add_command_line_option<double>(
+      "pending-age-bound",
+      "Warn when a send/recv stays unmatched longer than this, in ns");
+  cmd_parser.add_command_line_option<std::string>(
+      "contention-model",
+      "Link contention model (None, Reservation, Flow, or Queueing)");
+  cmd_parser.add_command_line_option<double>(
+      "queueing-window",
+      "Time constant of the link load smoothing (Queueing model), in ns");
 
   // 2. Network configs
   cmd_parser.add_command_line_option<std::string>(
@@ -78,6 +97,16 @@ int main(int argc, char* argv[]) {
       "hbm-latency", "HBM latency in ns");
   cmd_parser.add_command_line_multitoken_option<std::vector<double>>(
       "hbm-scale", "HBM scale");
+  cmd_parser.add_command_line_multitoken_option<std::vector<int>>(
+      "mtu", "Largest packet payload in bytes (0: no packetization)");
+  cmd_parser.add_command_line_multitoken_option<std::vector<int>>(
+      "header-size", "Header bytes per packet");
+  cmd_parser.add_command_line_multitoken_option<std::vector<double>>(
+      "line-coding-efficiency", "Fraction of link bandwidth left by encoding");
+  cmd_parser.add_command_line_multitoken_option<std::vector<int>>(
+      "min-frame-size", "Minimum frame size in bytes");
+  cmd_parser.add_command_line_option<std::string>(
+      "switching-mode", "Packet switching mode (CutThrough or StoreAndForward)");
 
   // Parse command line arguments
   try {
@@ -126,6 +155,21 @@ int main(int argc, char* argv[]) {
   bool rendezvous_protocol = false;
   cmd_parser.set_if_defined("rendezvous-protocol", &rendezvous_protocol);
 
+  std::string event_queue_scheduler = "Heap";
+  cmd_parser.set_if_defined("event-queue-scheduler", &event_queue_scheduler);
+
+  int threads_count = 1;
+  cmd_parser.set_if_defined("threads-count", &threads_count);
+
+  double pending_age_bound = 0;
+  cmd_parser.set_if_defined("pending-age-bound", &pending_age_bound);
+
+  std::string contention_model_name = "None";
+  cmd_parser.set_if_defined("contention-model", &contention_model_name);
+
+  double queueing_window = 10000; // 10 us
+  cmd_parser.set_if_defined("queueing-window", &queueing_window);
+
   // 2. Retrieve network configs
   std::string network_configuration =
       "../../../configuration.json"; // default configuration.json
@@ -197,11 +241,112 @@ int main(int argc, char* argv[]) {
   }
   cmd_parser.set_if_defined("hbm-scale", &hbm_scales);
 
+  // packetization is optional: messages are not split by default
+  std::vector<int> mtus(dims_count, 0);
+  if (json_configuration.count("mtu") > 0) {
+    mtus.clear();
+    for (int mtu : json_configuration["mtu"]) {
+      mtus.emplace_back(mtu);
+    }
+  }
+  cmd_parser.set_if_defined("mtu", &mtus);
+
+  // wire efficiency is optional: no overhead by default
+  std::vector<int> header_sizes(dims_count, 0);
+  if (json_configuration.count("header-size") > 0) {
+    header_sizes.clear();
+    for (int header_size : json_configuration["header-size"]) {
+      header_sizes.emplace_back(header_size);
+    }
+  }
+  cmd_parser.set_if_defined("header-size", &header_sizes);
+
+  std::vector<double> line_coding_efficiencies(dims_count, 1);
+  if (json_configuration.count("line-coding-efficiency") > 0) {
+    line_coding_efficiencies.clear();
+    for (double line_coding_efficiency :
+         json_configuration["line-coding-efficiency"]) {
+      line_coding_efficiencies.emplace_back(line_coding_efficiency);
+    }
+  }
+  cmd_parser.set_if_defined(
+      "line-coding-efficiency", &line_coding_efficiencies);
+
+  std::vector<int> min_frame_sizes(dims_count, 0);
+  if (json_configuration.count("min-frame-size") > 0) {
+    min_frame_sizes.clear();
+    for (int min_frame_size : json_configuration["min-frame-size"]) {
+      min_frame_sizes.emplace_back(min_frame_size);
+    }
+  }
+  cmd_parser.set_if_defined("min-frame-size", &min_frame_sizes);
+
+  std::string switching_mode_name = "CutThrough";
+  if (json_configuration.count("switching-mode") > 0) {
+    switching_mode_name = json_configuration["switching-mode"];
+  }
+  cmd_parser.set_if_defined("switching-mode", &switching_mode_name);
+
   /**
    * Instantitiation: Event Queue, System, Memory, Topology, etc.
    */
   // event queue instantiation
-  auto event_queue = std::make_shared<Analytical::EventQueue>();
+  auto scheduler_type = Analytical::EventQueue::SchedulerType::Heap;
+  if (event_queue_scheduler == "Heap") {
+    scheduler_type = Analytical::EventQueue::SchedulerType::Heap;
+  } else if (event_queue_scheduler == "List") {
+    scheduler_type = Analytical::EventQueue::SchedulerType::List;
+  } else {
+    std::cout << "[Main] Event queue scheduler not defined: "
+              << event_queue_scheduler << std::endl;
+    exit(-1);
+  }
+  auto event_queue = std::make_shared<Analytical::EventQueue>(scheduler_type);
+
+  // link contention model
+  auto contention_model = Analytical::Topology::ContentionModel::None;
+  if (contention_model_name == "None") {
+    contention_model = Analytical::Topology::ContentionModel::None;
+  } else if (contention_model_name == "Reservation") {
+    contention_model = Analytical::Topology::ContentionModel::Reservation;
+  } else if (contention_model_name == "Flow") {
+    contention_model = Analytical::Topology::ContentionModel::Flow;
+  } else if (contention_model_name == "Queueing") {
+    contention_model = Analytical::Topology::ContentionModel::Queueing;
+  } else {
+    std::cout << "[Main] Contention model not defined: "
+              << contention_model_name << std::endl;
+    exit(-1);
+  }
+  if (Analytical::TopologyConfiguration::nsToPs(queueing_window) <= 0) {
+    std::cout << "[Main] queueing-window should be positive" << std::endl;
+    exit(-1);
+  }
+
+  // packet switching mode
+  auto switching_mode = Analytical::Topology::SwitchingMode::CutThrough;
+  if (switching_mode_name == "CutThrough") {
+    switching_mode = Analytical::Topology::SwitchingMode::CutThrough;
+  } else if (switching_mode_name == "StoreAndForward") {
+    switching_mode = Analytical::Topology::SwitchingMode::StoreAndForward;
+  } else {
+    std::cout << "[Main] Switching mode not defined: " << switching_mode_name
+              << std::endl;
+    exit(-1);
+  }
+  for (int i = 0; i < dims_count; i++) {
+    if (mtus[i] < 0 || header_sizes[i] < 0 || min_frame_sizes[i] < 0) {
+      std::cout << "[Main] mtu, header-size, and min-frame-size should not be "
+                   "negative"
+                << std::endl;
+      exit(-1);
+    }
+    if (line_coding_efficiencies[i] <= 0 || line_coding_efficiencies[i] > 1) {
+      std::cout << "[Main] line-coding-efficiency should be in (0, 1]"
+                << std::endl;
+      exit(-1);
+    }
+  }
 
   // compute total number of npus by multiplying counts of each dimension
   auto npus_count = 1;
@@ -235,41 +380,66 @@ int main(int argc, char* argv[]) {
         router_latencies[i], // router latency (ns)
         hbm_latencies[i], // memory latency (ns),
         hbm_bandwidths[i], // memory bandwidth (GB/s) = (B/ns)
-        hbm_scales[i] // memory scaling factor
+        hbm_scales[i], // memory scaling factor
+        mtus[i], // largest packet payload (B)
+        header_sizes[i], // header bytes per packet (B)
+        line_coding_efficiencies[i], // fraction of bandwidth left by coding
+        min_frame_sizes[i] // minimum frame size (B)
     );
   }
 
   // Instantiate topology
-  if (topology_name == "Switch") {
-    topology = std::make_shared<Analytical::Switch>(
-        topology_configurations, // topology configuration
-        npus_count // number of connected nodes
-    );
-    nodes_count_for_system[2] = npus_count;
-  } else if (topology_name == "AllToAll") {
-    topology = std::make_shared<Analytical::AllToAll>(
-        topology_configurations, // topology configuration
-        npus_count // number of connected nodes
-    );
-    nodes_count_for_system[2] = npus_count;
-  } else if (topology_name == "Torus2D") {
-    topology = std::make_shared<Analytical::Torus2D>(
-        topology_configurations, // topology configuration
-        npus_count // number of connected nodes
-    );
+  // (the parallel engine creates one topology instance per partition)
+  auto instantiate_topology = [&]() -> std::shared_ptr<Analytical::Topology> {
+    if (topology_name == "Switch") {
+      return std::make_shared<Analytical::Switch>(
+          topology_configurations, // topology configuration
+          npus_count // number of connected nodes
+      );
+    } else if (topology_name == "AllToAll") {
+      return std::make_shared<Analytical::AllToAll>(
+          topology_configurations, // topology configuration
+          npus_count // number of connected nodes
+      );
+    } else if (topology_name == "Torus2D") {
+      return std::make_shared<Analytical::Torus2D>(
+          topology_configurations, // topology configuration
+          npus_count // number of connected nodes
+      );
+    } else if (topology_name == "Ring") {
+      return std::make_shared<Analytical::Ring>(
+          topology_configurations, // topology configuration
+          npus_count, // number of connected nodes,
+          true // is the ring bidirectional
+      );
+    }
+    return nullptr;
+  };
+
+  // every topology instance shares the link contention and switching modes
+  auto create_topology = [&]() -> std::shared_ptr<Analytical::Topology> {
+    auto new_topology = instantiate_topology();
+    if (new_topology != nullptr) {
+      new_topology->setContentionModel(contention_model);
+      new_topology->setSwitchingMode(switching_mode);
+      new_topology->setQueueingWindow(
+          Analytical::TopologyConfiguration::nsToPs(queueing_window));
+    }
+    return new_topology;
+  };
+
+  topology = create_topology();
+  if (topology == nullptr) {
+    std::cout << "[Main] Topology not defined: " << topology_name << std::endl;
+    exit(-1);
+  }
+
+  if (topology_name == "Torus2D") {
     auto torus_width = (int)std::sqrt(npus_count);
     nodes_count_for_system[1] = torus_width;
     nodes_count_for_system[2] = torus_width;
-  } else if (topology_name == "Ring") {
-    topology = std::make_shared<Analytical::Ring>(
-        topology_configurations, // topology configuration
-        npus_count, // number of connected nodes,
-        true // is the ring bidirectional
-    );
-    nodes_count_for_system[2] = npus_count;
   } else {
-    std::cout << "[Main] Topology not defined: " << topology_name << std::endl;
-    exit(-1);
+    nodes_count_for_system[2] = npus_count;
   }
 
   // Instantiate required network, memory, and system layers
@@ -315,6 +485,48 @@ int main(int argc, char* argv[]) {
   Analytical::AnalyticalNetwork::set_event_queue(event_queue);
   Analytical::AnalyticalNetwork::set_topology(topology);
 
+  // flow network: messages share link bandwidth as flows
+  if (contention_model == Analytical::Topology::ContentionModel::Flow) {
+    Analytical::AnalyticalNetwork::set_flow_network(
+        std::make_shared<Analytical::FlowNetwork>(event_queue, topology));
+  }
+
+  // parallel engine: each partition owns its event queue and topology
+  std::shared_ptr<Analytical::ParallelEngine> parallel_engine;
+  if (threads_count > 1) {
+    if (threads_count > npus_count) {
+      std::cout << "[Main] threads-count should not exceed the number of NPUs"
+                << std::endl;
+      exit(-1);
+    }
+    if (contention_model != Analytical::Topology::ContentionModel::None) {
+      // each partition's topology only sees its own npus' packets
+      std::cout << "[Main] Contention models require threads-count 1"
+                << std::endl;
+      exit(-1);
+    }
+    parallel_engine = std::make_shared<Analytical::ParallelEngine>(
+        npus_count,
+        threads_count,
+        scheduler_type,
+        create_topology);
+    if (parallel_engine->get_lookahead() <= 0) {
+      std::cout << "[Main] Parallel engine requires a positive minimum "
+                   "latency between two NPUs as lookahead"
+                << std::endl;
+      exit(-1);
+    }
+    Analytical::AnalyticalNetwork::set_parallel_engine(parallel_engine);
+  }
+
+  // watchdog of send/recv operations left unmatched
+  auto watchdog = Analytical::SendRecvWatchdog(
+      Analytical::TopologyConfiguration::nsToPs(pending_age_bound));
+  if (parallel_engine != nullptr) {
+    parallel_engine->set_pending_age_bound(
+        Analytical::TopologyConfiguration::nsToPs(pending_age_bound));
+  }
+
   /**
    * Run Analytical Model
    */
@@ -324,8 +536,46 @@ int main(int argc, char* argv[]) {
   }
 
   // Run events
-  while (!event_queue->empty()) {
-    event_queue->proceed();
+  if (parallel_engine != nullptr) {
+    parallel_engine->run();
+    std::cout << "[Main] Parallel engine ran "
+              << parallel_engine->get_windows_count()
+              << " windows (lookahead "
+              << parallel_engine->get_lookahead() / 1000.0 << " ns)"
+              << std::endl;
+  } else if (watchdog.is_enabled()) {
+    // stop at each watchdog check time
+    auto send_recv_tracking_maps =
+        Analytical::AnalyticalNetwork::get_send_recv_tracking_maps();
+    while (!event_queue->empty()) {
+      event_queue->run_until(watchdog.get_next_check_time());
+      if (!event_queue->empty()) {
+        // nothing happens until the next event: skip idle time
+        watchdog.check_pending_age(
+            send_recv_tracking_maps,
+            std::max(
+                watchdog.get_next_check_time(),
+                event_queue->next_event_time()));
+      }
+    }
+  } else {
+    while (!event_queue->empty()) {
+      event_queue->proceed();
+    }
+  }
+
+  // Report send/recv operations left unmatched, tracking memory usage,
+  // and how long matched operations waited for each other
+  Analytical::AnalyticalNetwork::print_send_recv_tracking_map();
+  Analytical::AnalyticalNetwork::print_wait_histograms();
+  auto end_time = (parallel_engine != nullptr)
+      ? parallel_engine->get_current_time()
+      : event_queue->get_current_time();
+  if (!Analytical::SendRecvWatchdog::report_unmatched(
+          Analytical::AnalyticalNetwork::get_send_recv_tracking_maps(),
+          end_time)) {
+    // event queue drained while operations wait for each other
+    exit(-1);
   }
 
   /**
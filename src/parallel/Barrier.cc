@@ -0,0 +1,31 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "Barrier.hh"
+
+#include <thread>
+
+Analytical::Barrier::Barrier(int threads_count) noexcept
+    : threads_count(threads_count),
+      arrived_threads_count(0),
+      generation(0) {}
+
+void Analytical::Barrier::wait() noexcept {
+  // read generation before arriving, so that a release by the last thread
+  // cannot be missed
+  auto current_generation = generation.load(std::memory_order_acquire);
+
+  if (arrived_threads_count.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+      threads_count) {
+    // last thread: reset counter and release everyone
+    arrived_threads_count.store(0, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    return;
+  }
+
+  while (generation.load(std::memory_order_acquire) == current_generation) {
+    std::this_thread::yield();
+  }
+}
@@ -0,0 +1,47 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __BARRIER_HH__
+#define __BARRIER_HH__
+
+#include <atomic>
+
+namespace Analytical {
+/**
+ * Reusable spinning barrier for a fixed number of threads.
+ * Every write made before wait() is visible to all threads after wait().
+ */
+class Barrier {
+ public:
+  /**
+   * Construct a barrier.
+   * @param threads_count number of threads synchronizing on this barrier
+   */
+  explicit Barrier(int threads_count) noexcept;
+
+  /**
+   * Block until all threads_count threads have called wait().
+   */
+  void wait() noexcept;
+
+ private:
+  /**
+   * number of threads synchronizing on this barrier
+   */
+  const int threads_count;
+
+  /**
+   * number of threads arrived in the current generation
+   */
+  std::atomic<int> arrived_threads_count;
+
+  /**
+   * incremented each time all threads have arrived
+   */
+  std::atomic<unsigned int> generation;
+};
+} // namespace Analytical
+
+#endif
@@ -0,0 +1,22 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "Mailbox.hh"
+
+Analytical::Mailbox::Mailbox(int senders_count) noexcept
+    : slots(senders_count) {}
+
+void Analytical::Mailbox::post(
+    int sender_id,
+    const Delivery& delivery) noexcept {
+  slots[sender_id].emplace_back(delivery);
+}
+
+void Analytical::Mailbox::drain(std::vector<Delivery>& deliveries) noexcept {
+  for (auto& slot : slots) {
+    deliveries.insert(deliveries.end(), slot.begin(), slot.end());
+    slot.clear();
+  }
+}
@@ -0,0 +1,67 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __MAILBOX_HH__
+#define __MAILBOX_HH__
+
+#include <vector>
+#include "../event-queue/EventKey.hh"
+#include "../event-queue/TimeStamp.hh"
+
+namespace Analytical {
+/**
+ * Inbound mailbox of a partition, carrying sends whose destination NPU
+ * lives in that partition.
+ *
+ * Each sender partition owns a dedicated slot, so posting never contends
+ * with other senders and needs no lock. Slots are only drained by the
+ * receiver after a window barrier, when no sender is posting.
+ */
+class Mailbox {
+ public:
+  /**
+   * A send operation to be matched at the destination partition.
+   */
+  struct Delivery {
+    int tag;
+    int src;
+    int dst;
+    int count;
+    TimeStamp send_time;
+    TimeStamp send_finish_time;
+    EventKey send_key; // key of the events issued by the send
+  };
+
+  /**
+   * Construct a mailbox.
+   * @param senders_count number of partitions that may post to this mailbox
+   */
+  explicit Mailbox(int senders_count) noexcept;
+
+  /**
+   * Post a delivery.
+   * (Should only be called by the thread running sender_id partition)
+   * @param sender_id id of the posting partition
+   * @param delivery
+   */
+  void post(int sender_id, const Delivery& delivery) noexcept;
+
+  /**
+   * Move every posted delivery into deliveries, and empty the mailbox.
+   * (Should only be called while no sender is posting)
+   * @param deliveries vector to append deliveries into
+   */
+  void drain(std::vector<Delivery>& deliveries) noexcept;
+
+ private:
+  /**
+   * slots[sender_id] holds deliveries posted by sender_id partition.
+   * (capacity is kept after draining)
+   */
+  std::vector<std::vector<Delivery>> slots;
+};
+} // namespace Analytical
+
+#endif
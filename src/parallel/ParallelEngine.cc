@@ -0,0 +1,172 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "ParallelEngine.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <thread>
+
+thread_local Analytical::Partition*
+    Analytical::ParallelEngine::running_partition = nullptr;
+
+Analytical::ParallelEngine::ParallelEngine(
+    int npus_count,
+    int threads_count,
+    EventQueue::SchedulerType scheduler_type,
+    const TopologyFactory& create_topology) noexcept
+    : npus_count(npus_count),
+      threads_count(threads_count),
+      next_event_times(threads_count),
+      barrier(threads_count) {
+  assert(
+      threads_count > 0 && threads_count <= npus_count &&
+      "<ParallelEngine::ParallelEngine> invalid threads_count");
+
+  for (int id = 0; id < threads_count; id++) {
+    partitions.emplace_back(new Partition(
+        first_npu_id(id),
+        first_npu_id(id + 1) - first_npu_id(id),
+        threads_count,
+        scheduler_type,
+        create_topology()));
+  }
+
+  lookahead = compute_lookahead(partitions.front()->get_topology());
+}
+
+Analytical::ParallelEngine::Latency Analytical::ParallelEngine::
+    compute_lookahead(const Topology& topology) noexcept {
+  return topology.minimumLatency();
+}
+
+Analytical::ParallelEngine::Latency Analytical::ParallelEngine::get_lookahead()
+    const noexcept {
+  return lookahead;
+}
+
+void Analytical::ParallelEngine::set_lookahead(Latency lookahead) noexcept {
+  assert(
+      (lookahead > 0 && lookahead <= this->lookahead) &&
+      "<ParallelEngine::set_lookahead> lookahead should only shrink");
+  this->lookahead = lookahead;
+}
+
+uint64_t Analytical::ParallelEngine::get_windows_count() const noexcept {
+  return windows_count;
+}
+
+int Analytical::ParallelEngine::partition_id(int npu_id) const noexcept {
+  // contiguous blocks of npus
+  return (int)(((long long)npu_id * threads_count) / npus_count);
+}
+
+int Analytical::ParallelEngine::first_npu_id(int id) const noexcept {
+  // smallest npu_id such that partition_id(npu_id) == id
+  return (int)(((long long)id * npus_count + threads_count - 1) / threads_count);
+}
+
+Analytical::Partition& Analytical::ParallelEngine::get_partition(
+    int npu_id) noexcept {
+  return *partitions[partition_id(npu_id)];
+}
+
+bool Analytical::ParallelEngine::is_same_partition(
+    int npu_id_a,
+    int npu_id_b) const noexcept {
+  return partition_id(npu_id_a) == partition_id(npu_id_b);
+}
+
+void Analytical::ParallelEngine::deliver(
+    const Mailbox::Delivery& delivery) noexcept {
+  auto sender_id = partition_id(delivery.src);
+  auto receiver_id = partition_id(delivery.dst);
+  assert(
+      (running_partition == nullptr ||
+       running_partition == partitions[sender_id].get()) &&
+      "<ParallelEngine::deliver> delivery posted from a foreign thread");
+
+  partitions[receiver_id]->get_mailbox().post(sender_id, delivery);
+}
+
+Analytical::Partition* Analytical::ParallelEngine::
+    get_running_partition() noexcept {
+  return running_partition;
+}
+
+void Analytical::ParallelEngine::set_pending_age_bound(
+    TimeStamp pending_age_bound) noexcept {
+  for (auto& partition : partitions) {
+    partition->set_pending_age_bound(pending_age_bound);
+  }
+}
+
+Analytical::TimeStamp Analytical::ParallelEngine::get_current_time()
+    const noexcept {
+  auto current_time = (TimeStamp)0;
+  for (const auto& partition : partitions) {
+    current_time = std::max(
+        current_time, partition->get_event_queue().get_current_time());
+  }
+  return current_time;
+}
+
+void Analytical::ParallelEngine::run() noexcept {
+  assert(
+      lookahead > 0 &&
+      "<ParallelEngine::run> lookahead should be positive to run in parallel");
+
+  auto workers = std::vector<std::thread>();
+  for (int id = 1; id < threads_count; id++) {
+    workers.emplace_back(&ParallelEngine::run_partition, this, id);
+  }
+
+  // main thread runs partition 0
+  run_partition(0);
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void Analytical::ParallelEngine::run_partition(int id) noexcept {
+  auto& partition = *partitions[id];
+  auto& event_queue = partition.get_event_queue();
+  running_partition = &partition;
+
+  while (true) {
+    // 1. match sends posted during the last window,
+    //    then publish the earliest pending event
+    partition.process_deliveries();
+    next_event_times[id] = event_queue.empty()
+        ? std::numeric_limits<TimeStamp>::max()
+        : event_queue.next_event_time();
+    barrier.wait();
+
+    // 2. every partition computes the same window
+    auto window_start =
+        *std::min_element(next_event_times.begin(), next_event_times.end());
+    if (window_start == std::numeric_limits<TimeStamp>::max()) {
+      // all event queues and mailboxes are drained
+      break;
+    }
+    auto window_end = window_start + lookahead;
+    if (id == 0) {
+      windows_count++;
+    }
+
+    // every event before window_start has run in every partition
+    partition.check_pending_age(window_start);
+
+    // 3. run local events inside the window
+    event_queue.run_until(window_end);
+
+    // 4. wait until every partition has posted its deliveries
+    barrier.wait();
+  }
+
+  running_partition = nullptr;
+}
@@ -0,0 +1,178 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __PARALLELENGINE_HH__
+#define __PARALLELENGINE_HH__
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "../event-queue/EventQueue.hh"
+#include "../topology/Topology.hh"
+#include "../topology/TopologyConfiguration.hh"
+#include "Barrier.hh"
+#include "Mailbox.hh"
+#include "Partition.hh"
+
+namespace Analytical {
+/**
+ * Conservative parallel discrete-event engine.
+ *
+ * NPUs are split into contiguous blocks, one Partition per thread.
+ * Threads advance in lockstep windows [start, start + lookahead), where
+ * start is the earliest pending event among all partitions. A send from
+ * another partition always finishes at least `lookahead` after it was
+ * issued, so it can only affect the destination partition in a later
+ * window: cross-partition sends are posted to the destination's Mailbox
+ * and matched at the next window boundary.
+ *
+ * Events run in the same order as in the sequential run: events sharing
+ * a time stamp are ordered by their EventKey (issue time, issuing npu,
+ * order among the events of that npu), not by the order they were added.
+ * So the recv handler of a cross-partition send, which is only added at
+ * the next window boundary, still runs before the events the destination
+ * issued later for the same time.
+ *
+ * Speculative (optimistic) execution is not supported: event handlers
+ * mutate system layer state that cannot be saved nor rolled back.
+ * The lookahead is instead taken as tight as the topology allows.
+ */
+class ParallelEngine {
+ public:
+  using Latency = TopologyConfiguration::Latency;
+  using TopologyFactory = std::function<std::shared_ptr<Topology>()>;
+
+  /**
+   * Construct a parallel engine.
+   * @param npus_count total number of npus
+   * @param threads_count number of worker threads (= number of partitions)
+   * @param scheduler_type scheduler backend of each partition's event queue
+   * @param create_topology function creating a new topology instance
+   */
+  ParallelEngine(
+      int npus_count,
+      int threads_count,
+      EventQueue::SchedulerType scheduler_type,
+      const TopologyFactory& create_topology) noexcept;
+
+  /**
+   * Compute the lookahead: the smallest latency of a send between two
+   * different NPUs reported by the topology.
+   * @param topology
+   * @return lookahead in ps
+   */
+  static Latency compute_lookahead(const Topology& topology) noexcept;
+
+  /**
+   * lookahead getter
+   * @return lookahead
+   */
+  Latency get_lookahead() const noexcept;
+
+  /**
+   * Shrink the lookahead (e.g., to measure how the number of windows
+   * depends on it). A larger lookahead than computed would be unsafe.
+   * @param lookahead new lookahead in ps, positive and at most the
+   *                  computed one
+   */
+  void set_lookahead(Latency lookahead) noexcept;
+
+  /**
+   * @return number of windows run so far
+   */
+  uint64_t get_windows_count() const noexcept;
+
+  /**
+   * Get the partition simulating given NPU.
+   * @param npu_id
+   * @return partition of the npu
+   */
+  Partition& get_partition(int npu_id) noexcept;
+
+  /**
+   * Check whether two NPUs are simulated by the same partition.
+   * @param npu_id_a
+   * @param npu_id_b
+   * @return true if both npus are in the same partition
+   */
+  bool is_same_partition(int npu_id_a, int npu_id_b) const noexcept;
+
+  /**
+   * Post a send operation to the partition of its destination.
+   * (Should be called by the thread running the partition of src)
+   * @param delivery
+   */
+  void deliver(const Mailbox::Delivery& delivery) noexcept;
+
+  /**
+   * Partition run by the calling thread.
+   * @return running partition, nullptr outside of run()
+   */
+  static Partition* get_running_partition() noexcept;
+
+  /**
+   * Bound the time operations may stay pending in send/recv tracking maps.
+   * Each partition checks its own npus' maps at window boundaries.
+   * @param pending_age_bound maximum pending time (in ps), 0: no bound
+   */
+  void set_pending_age_bound(TimeStamp pending_age_bound) noexcept;
+
+  /**
+   * Run every partition in parallel until all event queues are drained.
+   */
+  void run() noexcept;
+
+  /**
+   * @return latest current_time among the partitions (in ps)
+   */
+  TimeStamp get_current_time() const noexcept;
+
+ private:
+  /**
+   * Compute the partition id of given NPU.
+   * @param npu_id
+   * @return partition id
+   */
+  int partition_id(int npu_id) const noexcept;
+
+  /**
+   * Compute the id of the first NPU of given partition.
+   * @param id partition id (threads_count: one past the last partition)
+   * @return first npu id
+   */
+  int first_npu_id(int id) const noexcept;
+
+  /**
+   * Main loop of a worker thread.
+   * @param id id of the partition run by this thread
+   */
+  void run_partition(int id) noexcept;
+
+  int npus_count;
+  int threads_count;
+  Latency lookahead;
+  uint64_t windows_count = 0;
+  std::vector<std::unique_ptr<Partition>> partitions;
+
+  /**
+   * next_event_times[id]: earliest pending event of partition id,
+   * published at each window boundary
+   */
+  std::vector<TimeStamp> next_event_times;
+
+  /**
+   * window synchronization
+   */
+  Barrier barrier;
+
+  /**
+   * partition run by the current thread
+   */
+  static thread_local Partition* running_partition;
+};
+} // namespace Analytical
+
+#endif
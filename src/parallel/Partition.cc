@@ -0,0 +1,104 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "Partition.hh"
+
+#include <algorithm>
+#include <cassert>
+
+Analytical::Partition::Partition(
+    int first_npu_id,
+    int npus_count,
+    int partitions_count,
+    EventQueue::SchedulerType scheduler_type,
+    std::shared_ptr<Topology> topology) noexcept
+    : event_queue(std::make_shared<EventQueue>(scheduler_type)),
+      topology(std::move(topology)),
+      mailbox(partitions_count),
+      first_npu_id(first_npu_id),
+      send_recv_tracking_maps(npus_count, nullptr) {}
+
+Analytical::EventQueue& Analytical::Partition::get_event_queue() noexcept {
+  return *event_queue;
+}
+
+Analytical::Topology& Analytical::Partition::get_topology() noexcept {
+  return *topology;
+}
+
+void Analytical::Partition::set_send_recv_tracking_map(
+    int npu_id,
+    SendRecvTrackingMap* send_recv_tracking_map) noexcept {
+  auto index = npu_id - first_npu_id;
+  assert(
+      index >= 0 && index < (int)send_recv_tracking_maps.size() &&
+      "<Partition::set_send_recv_tracking_map> npu is not in this partition");
+  send_recv_tracking_maps[index] = send_recv_tracking_map;
+}
+
+Analytical::Mailbox& Analytical::Partition::get_mailbox() noexcept {
+  return mailbox;
+}
+
+void Analytical::Partition::process_deliveries() noexcept {
+  mailbox.drain(deliveries);
+
+  // deterministic processing order: sends of the same src are matched
+  // in the order they were issued, as in the sequential run
+  std::sort(
+      deliveries.begin(),
+      deliveries.end(),
+      [](const Mailbox::Delivery& delivery_a,
+         const Mailbox::Delivery& delivery_b) {
+        return delivery_a.send_key < delivery_b.send_key;
+      });
+
+  auto recv_event_handler = Event();
+  auto recv_key = EventKey();
+  for (const auto& delivery : deliveries) {
+    // match the recv operation if already issued,
+    // otherwise track this send operation in the shard of dst
+    auto send_recv_tracking_map =
+        send_recv_tracking_maps[delivery.dst - first_npu_id];
+    assert(
+        send_recv_tracking_map != nullptr &&
+        "<Partition::process_deliveries> dst has no tracking map");
+    if (send_recv_tracking_map->match_or_insert_send(
+            delivery.tag,
+            delivery.src,
+            delivery.dst,
+            delivery.count,
+            delivery.send_time,
+            delivery.send_finish_time,
+            delivery.send_key,
+            recv_event_handler,
+            recv_key)) {
+      // recv operation already issued: schedule recv event handler
+      // at the time the send finishes, keyed as in the sequential run
+      event_queue->add_event(
+          delivery.send_finish_time,
+          recv_event_handler,
+          std::max(delivery.send_key, recv_key));
+    }
+  }
+
+  deliveries.clear();
+}
+
+void Analytical::Partition::set_pending_age_bound(
+    TimeStamp pending_age_bound) noexcept {
+  watchdog = SendRecvWatchdog(pending_age_bound);
+}
+
+void Analytical::Partition::check_pending_age(TimeStamp current_time) noexcept {
+  if (current_time < watchdog.get_next_check_time()) {
+    return;
+  }
+
+  auto maps = SendRecvWatchdog::SendRecvTrackingMaps(
+      send_recv_tracking_maps.begin(), send_recv_tracking_maps.end());
+  maps.erase(std::remove(maps.begin(), maps.end(), nullptr), maps.end());
+  watchdog.check_pending_age(maps, current_time);
+}
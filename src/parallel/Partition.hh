@@ -0,0 +1,120 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __PARTITION_HH__
+#define __PARTITION_HH__
+
+#include <memory>
+#include <vector>
+#include "../api/SendRecvTrackingMap.hh"
+#include "../api/SendRecvWatchdog.hh"
+#include "../event-queue/EventQueue.hh"
+#include "../topology/Topology.hh"
+#include "Mailbox.hh"
+
+namespace Analytical {
+/**
+ * A group of NPUs simulated by a single thread of the ParallelEngine.
+ * Each partition has its own event queue, topology instance (so that link
+ * stats are never shared across threads) and inbound mailbox.
+ * Send/recv tracking maps are owned by each destination NPU's network:
+ * the partition only matches its inbound deliveries into them.
+ */
+class Partition {
+ public:
+  /**
+   * Construct a partition.
+   * @param first_npu_id id of the first npu of this partition
+   * @param npus_count number of npus in this partition
+   * @param partitions_count total number of partitions
+   * @param scheduler_type scheduler backend of the event queue
+   * @param topology topology instance owned by this partition
+   */
+  Partition(
+      int first_npu_id,
+      int npus_count,
+      int partitions_count,
+      EventQueue::SchedulerType scheduler_type,
+      std::shared_ptr<Topology> topology) noexcept;
+
+  /**
+   * event_queue getter
+   * @return event_queue
+   */
+  EventQueue& get_event_queue() noexcept;
+
+  /**
+   * topology getter
+   * @return topology
+   */
+  Topology& get_topology() noexcept;
+
+  /**
+   * Register the send/recv tracking map of an npu of this partition,
+   * which deliveries destined to the npu are matched into.
+   * @param npu_id id of the npu
+   * @param send_recv_tracking_map inbound tracking map of the npu
+   */
+  void set_send_recv_tracking_map(
+      int npu_id,
+      SendRecvTrackingMap* send_recv_tracking_map) noexcept;
+
+  /**
+   * mailbox getter
+   * @return mailbox
+   */
+  Mailbox& get_mailbox() noexcept;
+
+  /**
+   * Match every delivery posted to the mailbox against pending recv
+   * operations. Deliveries are processed in send key order, so that the
+   * result does not depend on thread scheduling.
+   */
+  void process_deliveries() noexcept;
+
+  /**
+   * Bound the time operations destined to this partition's npus may stay
+   * pending, warning when exceeded.
+   * @param pending_age_bound maximum pending time (in ps), 0: no bound
+   */
+  void set_pending_age_bound(TimeStamp pending_age_bound) noexcept;
+
+  /**
+   * Run the watchdog over this partition's npus' tracking maps,
+   * if a check is due.
+   * (Should only be called by the thread running this partition)
+   * @param current_time time every event before it has run (in ps)
+   */
+  void check_pending_age(TimeStamp current_time) noexcept;
+
+ private:
+  std::shared_ptr<EventQueue> event_queue;
+  std::shared_ptr<Topology> topology;
+  Mailbox mailbox;
+
+  /**
+   * id of the first npu of this partition
+   */
+  int first_npu_id;
+
+  /**
+   * send_recv_tracking_maps[npu_id - first_npu_id]:
+   * inbound tracking map of npu_id
+   */
+  std::vector<SendRecvTrackingMap*> send_recv_tracking_maps;
+
+  /**
+   * watchdog of the operations pending in send_recv_tracking_maps
+   */
+  SendRecvWatchdog watchdog;
+
+  /**
+   * scratch buffer used by process_deliveries
+   */
+  std::vector<Mailbox::Delivery> deliveries;
+};
+} // namespace Analytical
+
+#endif
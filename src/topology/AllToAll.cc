@@ -4,21 +4,31 @@ LICENSE file in the root directory of this source tree.
 *******************************************************************************/
 
 #include "AllToAll.hh"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
 
 using namespace Analytical;
 
 AllToAll::AllToAll(
     const TopologyConfigurations& configurations,
-    int npus_count) noexcept {
+    int npus_count) noexcept
+    : npus_count(npus_count) {
+  // all npus are connected directly: npus_count * (npus_count - 1) links
+  auto links_count = (int64_t)npus_count * (npus_count - 1);
+  if (links_count > std::numeric_limits<LinkId>::max()) {
+    // link ids would overflow (also in release builds)
+    std::cout << "[AllToAll, constructor] " << npus_count << " npus need "
+              << links_count << " links, more than link ids can index"
+              << std::endl;
+    exit(-1);
+  }
+
   this->configurations = configurations;
 
-  // connect all npus directly
-  for (int n1 = 0; n1 < (npus_count - 1); n1++) {
-    for (int n2 = (n1 + 1); n2 < npus_count; n2++) {
-      connect(n1, n2, 0);
-      connect(n2, n1, 0);
-    }
-  }
+  // links are allocated only once used
+  declareImplicitLinks((int)links_count, 0, true);
 }
 
 Topology::Latency AllToAll::send(
@@ -35,7 +45,16 @@ Topology::Latency AllToAll::send(
   // 3. Dest nic latency
   auto link_latency = serialize(payload_size, 0);
   link_latency += nicLatency(0);
-  link_latency += route(src_id, dest_id, payload_size);
+  auto link_id = directLinkId(src_id, dest_id);
+  link_latency += route(link_id, payload_size);
+
+  if (contention_model != ContentionModel::None) {
+    // contend with other packets on the link
+    path.push_back(link_id);
+    link_latency += contendPath(
+        payload_size, 0, configurations[0].getLinkLatency());
+  }
+
   link_latency += nicLatency(0);
 
   auto hbm_latency = hbmLatency(payload_size, 0);
@@ -43,6 +62,13 @@ Topology::Latency AllToAll::send(
   return criticalLatency(link_latency, hbm_latency);
 }
 
+Topology::LinkId AllToAll::directLinkId(NpuId src_id, NpuId dest_id)
+    const noexcept {
+  // outgoing links of src, ordered by dest (skipping src itself)
+  auto dest_index = (dest_id < src_id) ? dest_id : (dest_id - 1);
+  return (src_id * (npus_count - 1)) + dest_index;
+}
+
 Topology::NpuAddress AllToAll::npuIdToAddress(NpuId id) const noexcept {
   return NpuAddress(1, id);
 }
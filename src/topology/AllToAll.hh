@@ -30,6 +30,16 @@ class AllToAll : public Topology {
  private:
   NpuAddress npuIdToAddress(NpuId id) const noexcept override;
   NpuId npuAddressToId(const NpuAddress& address) const noexcept override;
+
+  /**
+   * Compute the id of the link connecting from src to dest.
+   * @param src_id
+   * @param dest_id
+   * @return link id
+   */
+  LinkId directLinkId(NpuId src_id, NpuId dest_id) const noexcept;
+
+  int npus_count; // number of npus connected together
 };
 } // namespace Analytical
 
@@ -4,23 +4,116 @@ LICENSE file in the root directory of this source tree.
 *******************************************************************************/
 
 #include "Link.hh"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 using namespace Analytical;
 
-Link::Link(Latency link_latency) noexcept : link_latency(link_latency) {}
+Link::Link(Latency link_latency, Bandwidth link_bandwidth) noexcept
+    : link_latency(link_latency),
+      link_bandwidth(link_bandwidth),
+      served_payloads_count(0),
+      served_payloads_size(0),
+      total_latency(0),
+      busy_until(0),
+      smoothed_work(0),
+      smoothed_payloads_count(0),
+      load_update_time(0),
+      total_queueing_delay(0) {}
 
-Link::Link() noexcept : Link(-1) {}
+Link::Link() noexcept : Link(0, 0) {}
 
 Link::Latency Link::send(PayloadSize payload_size) noexcept {
   assert(
       link_latency > 0 &&
-      "[Link, method send] link latency is less than zero. Default constructor may be accidentally triggered somewhere.");
+      "[Link, method send] link latency is zero. Default constructor may be accidentally triggered somewhere.");
 
+  record(payload_size);
+
+  return link_latency;
+}
+
+void Link::record(PayloadSize payload_size) noexcept {
   // update stats
   served_payloads_count++;
   served_payloads_size += payload_size;
   total_latency += link_latency;
+}
+
+void Link::record(int payloads_count, PayloadSize payloads_size) noexcept {
+  // update stats
+  served_payloads_count += payloads_count;
+  served_payloads_size += payloads_size;
+  total_latency += payloads_count * link_latency;
+}
+
+void Link::recordQueueingDelay(Latency queueing_delay) noexcept {
+  total_queueing_delay += queueing_delay;
+}
 
+Link::Latency Link::getLinkLatency() const noexcept {
   return link_latency;
 }
+
+Link::Latency Link::reserve(
+    Latency arrival_time,
+    Latency occupancy_time) noexcept {
+  // wait until earlier payloads have passed
+  auto start_time = std::max(arrival_time, busy_until);
+  busy_until = start_time + occupancy_time;
+  total_queueing_delay += start_time - arrival_time;
+  return start_time;
+}
+
+Link::Latency Link::estimateWait(
+    Latency arrival_time,
+    Latency occupancy_time,
+    Latency window) noexcept {
+  assert(window > 0 && "[Link, method estimateWait] window is not positive");
+
+  // decay the load offered so far
+  // (payloads of a path may reach the link slightly out of order)
+  if (arrival_time > load_update_time) {
+    auto decay =
+        std::exp(-(double)(arrival_time - load_update_time) / (double)window);
+    smoothed_work *= decay;
+    smoothed_payloads_count *= decay;
+    load_update_time = arrival_time;
+  }
+
+  // M/D/1 mean waiting time: rho * service / (2 * (1 - rho)),
+  // with utilization capped below 1 to keep overloaded links finite
+  auto queueing_delay = (Latency)0;
+  if (smoothed_payloads_count > 0) {
+    auto utilization = std::min(smoothed_work / (double)window, 0.99);
+    auto service_time = smoothed_work / smoothed_payloads_count;
+    queueing_delay = (Latency)std::llround(
+        utilization * service_time / (2 * (1 - utilization)));
+  }
+
+  smoothed_work += (double)occupancy_time;
+  smoothed_payloads_count += 1;
+  total_queueing_delay += queueing_delay;
+  return queueing_delay;
+}
+
+Link::Bandwidth Link::getLinkBandwidth() const noexcept {
+  return link_bandwidth;
+}
+
+int Link::getServedPayloadsCount() const noexcept {
+  return served_payloads_count;
+}
+
+Link::PayloadSize Link::getServedPayloadsSize() const noexcept {
+  return served_payloads_size;
+}
+
+Link::Latency Link::getTotalLatency() const noexcept {
+  return total_latency;
+}
+
+Link::Latency Link::getTotalQueueingDelay() const noexcept {
+  return total_queueing_delay;
+}
@@ -18,9 +18,10 @@ class Link {
   /**
    * Construct new link.
    *
-   * @param configuration Link configuration
+   * @param link_latency
+   * @param link_bandwidth
    */
-  explicit Link(Latency link_latency) noexcept;
+  Link(Latency link_latency, Bandwidth link_bandwidth) noexcept;
 
   Link() noexcept; // default constructor -- should not be called explicitly
 
@@ -32,13 +33,93 @@ class Link {
    */
   Latency send(PayloadSize payload_size) noexcept;
 
+  /**
+   * Update link stats for a payload passing through this link,
+   * without computing the latency.
+   *
+   * @param payload_size
+   */
+  void record(PayloadSize payload_size) noexcept;
+
+  /**
+   * Update link stats for several payloads passing through this link.
+   *
+   * @param payloads_count number of payloads
+   * @param payloads_size summation of the payloads' size
+   */
+  void record(int payloads_count, PayloadSize payloads_size) noexcept;
+
+  /**
+   * Add the queueing delay of payloads estimated elsewhere (e.g., by the
+   * lane of this link) to the link stats.
+   *
+   * @param queueing_delay summation of the payloads' queueing delay
+   */
+  void recordQueueingDelay(Latency queueing_delay) noexcept;
+
+  /**
+   * Return the latency of a transmission through this link.
+   *
+   * @return link latency
+   */
+  Latency getLinkLatency() const noexcept;
+
+  /**
+   * Return the bandwidth of this link, after line coding.
+   *
+   * @return link bandwidth
+   */
+  Bandwidth getLinkBandwidth() const noexcept;
+
+  /**
+   * Reserve this link for a payload, queueing behind earlier payloads.
+   * (Used by the reservation contention model)
+   *
+   * @param arrival_time time the payload reaches the link
+   * @param occupancy_time time the payload occupies the link
+   * @return time the payload starts passing the link
+   */
+  Latency reserve(Latency arrival_time, Latency occupancy_time) noexcept;
+
+  /**
+   * Estimate the queueing delay of a payload reaching this link, as the
+   * mean M/D/1 waiting time under the offered load smoothed over the
+   * recent payloads, then add the payload to the offered load.
+   * (Used by the queueing contention model)
+   *
+   * @param arrival_time time the payload reaches the link
+   * @param occupancy_time time the payload occupies the link
+   * @param window time constant (in ps) of the exponential smoothing
+   * @return estimated queueing delay of the payload
+   */
+  Latency estimateWait(
+      Latency arrival_time,
+      Latency occupancy_time,
+      Latency window) noexcept;
+
+  int getServedPayloadsCount() const noexcept;
+  PayloadSize getServedPayloadsSize() const noexcept;
+  Latency getTotalLatency() const noexcept;
+  Latency getTotalQueueingDelay() const noexcept;
+
  private:
   Latency link_latency;
+  Bandwidth link_bandwidth;
 
   int served_payloads_count; // the number of served payloads
   PayloadSize served_payloads_size; // summation of payloads' size which passed
                                     // this link
   Latency total_latency; // summation of total latency of each send
+
+  Latency busy_until; // time the link becomes free (reservation model)
+
+  // offered load, exponentially smoothed up to load_update_time
+  // (queueing model)
+  double smoothed_work; // occupancy time of recent payloads (in ps)
+  double smoothed_payloads_count; // number of recent payloads
+  Latency load_update_time;
+
+  Latency total_queueing_delay; // summation of queueing delay of each payload
 };
 } // namespace Analytical
 
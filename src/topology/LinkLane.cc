@@ -0,0 +1,148 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include "LinkLane.hh"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+using namespace Analytical;
+
+LinkLane::LinkLane(std::vector<LinkId> link_ids) noexcept
+    : link_ids(std::move(link_ids)),
+      payloads_count_deltas(this->link_ids.size() + 1, 0),
+      payloads_size_deltas(this->link_ids.size() + 1, 0),
+      queueing_delay_deltas(this->link_ids.size() + 1, 0) {}
+
+void LinkLane::recordHops(
+    int start,
+    int hops_count,
+    PayloadSize payload_size) noexcept {
+  assert(
+      (start >= 0 && start < (int)link_ids.size()) &&
+      "[LinkLane, method recordHops] start out of bound");
+  assert(
+      (hops_count >= 0 && hops_count <= (int)link_ids.size()) &&
+      "[LinkLane, method recordHops] more hops than links in the lane");
+
+  if (hops_count == 0) {
+    return;
+  }
+
+  addHops(payloads_count_deltas, start, hops_count, 1);
+  addHops(payloads_size_deltas, start, hops_count, payload_size);
+  has_pending_stats = true;
+}
+
+LinkLane::Latency LinkLane::estimateWait(
+    Latency arrival_time,
+    Latency occupancy_time,
+    int start,
+    int hops_count,
+    Latency window) noexcept {
+  auto length = (int)link_ids.size();
+  assert(
+      window > 0 && "[LinkLane, method estimateWait] window is not positive");
+  assert(
+      (start >= 0 && start < length) &&
+      "[LinkLane, method estimateWait] start out of bound");
+  assert(
+      (hops_count >= 0 && hops_count <= length) &&
+      "[LinkLane, method estimateWait] more hops than links in the lane");
+
+  if (hops_count == 0) {
+    return 0;
+  }
+
+  // decay the load offered so far
+  if (arrival_time > load_update_time) {
+    auto decay =
+        std::exp(-(double)(arrival_time - load_update_time) / (double)window);
+    smoothed_work *= decay;
+    smoothed_payloads_count *= decay;
+    load_update_time = arrival_time;
+  }
+
+  // M/D/1 mean waiting time on each link (as Link::estimateWait)
+  auto queueing_delay = (Latency)0;
+  if (smoothed_payloads_count > 0) {
+    auto utilization = std::min(smoothed_work / (double)window, 0.99);
+    auto service_time = smoothed_work / smoothed_payloads_count;
+    queueing_delay = (Latency)std::llround(
+        utilization * service_time / (2 * (1 - utilization)));
+  }
+
+  // the payload loads hops_count of the lane's links
+  auto loaded_fraction = (double)hops_count / length;
+  smoothed_work += loaded_fraction * (double)occupancy_time;
+  smoothed_payloads_count += loaded_fraction;
+
+  if (queueing_delay > 0) {
+    addHops(queueing_delay_deltas, start, hops_count, queueing_delay);
+    has_pending_stats = true;
+  }
+  return hops_count * queueing_delay;
+}
+
+LinkLane::LinkId LinkLane::getLinkId(int position) const noexcept {
+  assert(
+      (position >= 0 && position < (int)link_ids.size()) &&
+      "[LinkLane, method getLinkId] position out of bound");
+  return link_ids[position];
+}
+
+int LinkLane::length() const noexcept {
+  return (int)link_ids.size();
+}
+
+bool LinkLane::hasPendingStats() const noexcept {
+  return has_pending_stats;
+}
+
+void LinkLane::materialize(std::vector<Link>& links) noexcept {
+  if (!has_pending_stats) {
+    return;
+  }
+
+  auto payloads_count = (int64_t)0;
+  auto payloads_size = (int64_t)0;
+  auto queueing_delay = (int64_t)0;
+  for (auto position = (size_t)0; position < link_ids.size(); position++) {
+    payloads_count += payloads_count_deltas[position];
+    payloads_size += payloads_size_deltas[position];
+    queueing_delay += queueing_delay_deltas[position];
+    if (payloads_count > 0) {
+      links[link_ids[position]].record(
+          (int)payloads_count, (PayloadSize)payloads_size);
+    }
+    if (queueing_delay > 0) {
+      links[link_ids[position]].recordQueueingDelay((Latency)queueing_delay);
+    }
+  }
+
+  std::fill(payloads_count_deltas.begin(), payloads_count_deltas.end(), 0);
+  std::fill(payloads_size_deltas.begin(), payloads_size_deltas.end(), 0);
+  std::fill(queueing_delay_deltas.begin(), queueing_delay_deltas.end(), 0);
+  has_pending_stats = false;
+}
+
+void LinkLane::addHops(
+    std::vector<int64_t>& deltas,
+    int start,
+    int hops_count,
+    int64_t value) noexcept {
+  auto length = (int)link_ids.size();
+  auto end = start + hops_count;
+  deltas[start] += value;
+  if (end <= length) {
+    deltas[end] -= value;
+  } else {
+    // wraps around the lane: [start, length) and [0, end - length)
+    deltas[length] -= value;
+    deltas[0] += value;
+    deltas[end - length] -= value;
+  }
+}
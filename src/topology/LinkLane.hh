@@ -0,0 +1,124 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#ifndef __LINKLANE_HH__
+#define __LINKLANE_HH__
+
+#include <cstdint>
+#include <vector>
+#include "Link.hh"
+#include "TopologyConfiguration.hh"
+
+namespace Analytical {
+/**
+ * Cyclic sequence of links a packet passes one after another
+ * (e.g., one direction of a ring, or of a torus row).
+ *
+ * Link stats of a packet passing consecutive links are accumulated
+ * by a constant-time range update into difference arrays,
+ * and only added into the links when the stats are read.
+ *
+ * Under the queueing contention model, the lane also keeps the offered
+ * load of its links as a whole (as if spread evenly over them), so the
+ * queueing delay of a packet is estimated in constant time whatever the
+ * number of links it passes.
+ */
+class LinkLane {
+ public:
+  using LinkId = int;
+  using Latency = TopologyConfiguration::Latency;
+  using PayloadSize = TopologyConfiguration::PayloadSize;
+
+  /**
+   * Construct a lane.
+   * @param link_ids link_ids[position]: link at each position of the lane
+   */
+  explicit LinkLane(std::vector<LinkId> link_ids) noexcept;
+
+  /**
+   * Record a packet passing hops_count consecutive links.
+   * @param start position of the first link passed
+   * @param hops_count number of links passed (at most the lane length)
+   * @param payload_size
+   */
+  void recordHops(int start, int hops_count, PayloadSize payload_size) noexcept;
+
+  /**
+   * Estimate the queueing delay of a payload passing hops_count
+   * consecutive links, as Link::estimateWait would on each of them, but
+   * under the offered load per link of the whole lane; then add the
+   * payload to the offered load, and its queueing delay to the link stats.
+   * (Used by the queueing contention model)
+   * @param arrival_time time the payload reaches the first link passed
+   * @param occupancy_time time the payload occupies each link
+   * @param start position of the first link passed
+   * @param hops_count number of links passed (at most the lane length)
+   * @param window time constant (in ps) of the exponential smoothing
+   * @return estimated queueing delay of the payload over the links passed
+   */
+  Latency estimateWait(
+      Latency arrival_time,
+      Latency occupancy_time,
+      int start,
+      int hops_count,
+      Latency window) noexcept;
+
+  /**
+   * @param position position in the lane
+   * @return id of the link at given position
+   */
+  LinkId getLinkId(int position) const noexcept;
+
+  /**
+   * @return number of links in the lane
+   */
+  int length() const noexcept;
+
+  /**
+   * @return whether any packet is recorded since the last materialize
+   */
+  bool hasPendingStats() const noexcept;
+
+  /**
+   * Add the stats recorded so far into the links, then reset the lane.
+   * @param links links indexed by link id
+   */
+  void materialize(std::vector<Link>& links) noexcept;
+
+ private:
+  /**
+   * Add value to the consecutive positions passed by a packet.
+   * @param deltas difference array to update
+   * @param start position of the first link passed
+   * @param hops_count number of links passed (at most the lane length)
+   * @param value
+   */
+  void addHops(
+      std::vector<int64_t>& deltas,
+      int start,
+      int hops_count,
+      int64_t value) noexcept;
+
+  std::vector<LinkId> link_ids; // link at each position
+
+  /**
+   * difference arrays: the number (and the total size) of payloads passing
+   * position i is the prefix sum of deltas up to i
+   */
+  std::vector<int64_t> payloads_count_deltas;
+  std::vector<int64_t> payloads_size_deltas;
+  std::vector<int64_t> queueing_delay_deltas;
+
+  bool has_pending_stats = false; // whether any packet is recorded
+
+  // offered load per link, exponentially smoothed up to load_update_time
+  // (queueing model)
+  double smoothed_work = 0; // occupancy time of recent payloads (in ps)
+  double smoothed_payloads_count = 0; // number of recent payloads
+  Latency load_update_time = 0;
+};
+} // namespace Analytical
+
+#endif
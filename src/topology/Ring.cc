@@ -4,6 +4,7 @@ LICENSE file in the root directory of this source tree.
 *******************************************************************************/
 
 #include "Ring.hh"
+#include <utility>
 
 using namespace Analytical;
 
@@ -38,6 +39,25 @@ Ring::Ring(
     n2 = npus_count - 1;
     connect(n1, n2, 0);
   }
+
+  // pack links into the link arrays
+  buildLinks();
+
+  // lanes of links, in the order packets pass them
+  auto forward_links = std::vector<LinkId>();
+  for (auto npu_id = 0; npu_id < npus_count; npu_id++) {
+    forward_links.push_back(linkId(npu_id, (npu_id + 1) % npus_count));
+  }
+  forward_lane = addLane(std::move(forward_links));
+
+  if (bidirectional) {
+    auto backward_links = std::vector<LinkId>();
+    for (auto npu_id = npus_count - 1; npu_id >= 0; npu_id--) {
+      backward_links.push_back(
+          linkId(npu_id, (npu_id + npus_count - 1) % npus_count));
+    }
+    backward_lane = addLane(std::move(backward_links));
+  }
 }
 
 Topology::Latency Ring::send(
@@ -49,20 +69,26 @@ Topology::Latency Ring::send(
     return 0;
   }
 
-  // compute which direction to move
+  // compute which direction to move, and how far
   auto direction = computeDirection(src_id, dest_id);
+  auto hops_count = hopsCount(src_id, dest_id, direction);
 
-  // serialize packet
-  auto link_latency = serialize(payload_size, 0);
+  // serialize packets, pipelined over the path
+  auto link_latency = pipelinedSerialize(payload_size, 0, hops_count - 1);
   link_latency += nicLatency(0);
 
-  // move towards direction until reaching destination
-  auto current_id = src_id;
-  while (current_id != dest_id) {
-    auto next_id = takeStep(current_id, direction);
-
-    link_latency += route(current_id, next_id, payload_size);
-    current_id = next_id;
+  // move towards direction until reaching destination:
+  // every link of the ring has the same latency
+  link_latency += hops_count * configurations[0].getLinkLatency();
+  recordHops(src_id, direction, hops_count, payload_size);
+
+  if (contention_model != ContentionModel::None) {
+    // contend with other packets on the links passed
+    link_latency += contendPath(
+        payload_size,
+        0,
+        configurations[0].getLinkLatency() +
+            forwardingDelay(payload_size, 0));
   }
 
   link_latency += nicLatency(0);
@@ -97,18 +123,22 @@ Ring::Direction Ring::computeDirection(NpuId src_id, NpuId dest_id)
   return (distance <= half_npus_count) ? -1 : 1;
 }
 
-Ring::NpuId Ring::takeStep(NpuId current_id, Direction direction)
+int Ring::hopsCount(NpuId src_id, NpuId dest_id, Direction direction)
     const noexcept {
-  // compute next id
-  auto next_id = current_id + direction;
-
-  if (next_id >= npus_count) {
-    // out of positive bounds
-    next_id %= npus_count;
-  } else if (next_id < 0) {
-    // out of negative bounds
-    next_id = npus_count + (next_id % npus_count);
-  }
+  auto distance = (direction > 0) ? (dest_id - src_id) : (src_id - dest_id);
+  return (distance + npus_count) % npus_count;
+}
 
-  return next_id;
+void Ring::recordHops(
+    NpuId src_id,
+    Direction direction,
+    int hops_count,
+    PayloadSize payload_size) noexcept {
+  auto lane_id = (direction > 0) ? forward_lane : backward_lane;
+  auto start = (direction > 0) ? src_id : (npus_count - 1 - src_id);
+
+  recordLaneHops(lane_id, start, hops_count, payload_size);
+  if (contention_model != ContentionModel::None) {
+    appendLaneHops(lane_id, start, hops_count);
+  }
 }
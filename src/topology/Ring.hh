@@ -48,14 +48,36 @@ class Ring : public Topology {
   Direction computeDirection(NpuId src_id, NpuId dest_id) const noexcept;
 
   /**
-   * Take a step towards the given direction and return the destined node after
-   * taking single step.
+   * Count the hops from src to dest, moving towards the given direction.
    *
-   * @param current_id
-   * @param direction direction to take a step
-   * @return npuId after taking a step
+   * @param src_id
+   * @param dest_id
+   * @param direction direction to move
+   * @return number of hops
+   */
+  int hopsCount(NpuId src_id, NpuId dest_id, Direction direction)
+      const noexcept;
+
+  /**
+   * Update stats of the links passed by a packet, by a range update
+   * into the lane of its direction. Under a contention model, the links
+   * are also appended to path.
+   *
+   * @param src_id
+   * @param direction direction the packet moves
+   * @param hops_count number of hops the packet takes
+   * @param payload_size
    */
-  NpuId takeStep(NpuId current_id, Direction direction) const noexcept;
+  void recordHops(
+      NpuId src_id,
+      Direction direction,
+      int hops_count,
+      PayloadSize payload_size) noexcept;
+
+  // lanes of links: position i of the forward lane is link i -> i + 1,
+  // and position i of the backward lane is link (n - 1 - i) -> (n - 2 - i)
+  int forward_lane = -1;
+  int backward_lane = -1;
 };
 } // namespace Analytical
 
@@ -4,6 +4,7 @@ LICENSE file in the root directory of this source tree.
 *******************************************************************************/
 
 #include "Switch.hh"
+#include <algorithm>
 
 using namespace Analytical;
 
@@ -15,12 +16,9 @@ Switch::Switch(
   // set a switch id
   switch_id = npus_count;
 
-  // 1. Connect all NPUs to a switch: input port
-  // 2. Connect the switch to all NPUs: output port
-  for (auto npu_id = 0; npu_id < npus_count; npu_id++) {
-    connect(npu_id, switch_id, 0); // input port
-    connect(switch_id, npu_id, 0); // output port
-  }
+  // 1. Connect all NPUs to a switch: input port (link npu_id)
+  // 2. Connect the switch to all NPUs: output port (link npus_count + npu_id)
+  declareImplicitLinks(2 * npus_count, 0, false);
 }
 
 Topology::Latency Switch::send(
@@ -38,11 +36,23 @@ Topology::Latency Switch::send(
   //      3. add switch delay
   //      4. move from switch to dest
   //      5. pass destination nic
-  auto link_latency = serialize(payload_size, 0);
+  // (packets are pipelined through the switch)
+  auto link_latency = pipelinedSerialize(payload_size, 0, 1);
   link_latency += nicLatency(0);
-  link_latency += route(src_id, switch_id, payload_size);
+  link_latency += route(inputLinkId(src_id), payload_size);
   link_latency += routerLatency(0);
-  link_latency += route(switch_id, dest_id, payload_size);
+  link_latency += route(outputLinkId(dest_id), payload_size);
+
+  if (contention_model != ContentionModel::None) {
+    // contend with other packets on the input and output ports
+    path.push_back(inputLinkId(src_id));
+    path.push_back(outputLinkId(dest_id));
+    link_latency += contendPath(
+        payload_size,
+        0,
+        configurations[0].getLinkLatency() + routerLatency(0) +
+            forwardingDelay(payload_size, 0));
+  }
   link_latency += nicLatency(0);
 
   auto hbm_latency = hbmLatency(payload_size, 0);
@@ -50,6 +60,25 @@ Topology::Latency Switch::send(
   return criticalLatency(link_latency, hbm_latency);
 }
 
+Topology::Latency Switch::minimumLatency() const noexcept {
+  // every packet passes two links and the switch
+  auto link_latency = 2 * configurations[0].getLinkLatency();
+  link_latency += 2 * nicLatency(0);
+  link_latency += routerLatency(0);
+
+  auto hbm_latency = hbmLatency(0, 0);
+
+  return std::max(link_latency, hbm_latency);
+}
+
+Topology::LinkId Switch::inputLinkId(NpuId npu_id) const noexcept {
+  return npu_id;
+}
+
+Topology::LinkId Switch::outputLinkId(NpuId npu_id) const noexcept {
+  return switch_id + npu_id;
+}
+
 Topology::NpuAddress Switch::npuIdToAddress(NpuId id) const noexcept {
   return NpuAddress(1, id);
 }
@@ -26,11 +26,27 @@ class Switch : public Topology {
   Latency send(NpuId src_id, NpuId dest_id, PayloadSize payload_size) noexcept
       override;
 
+  Latency minimumLatency() const noexcept override;
+
  private:
   NpuAddress npuIdToAddress(NpuId id) const noexcept override;
   NpuId npuAddressToId(const NpuAddress& address) const noexcept override;
 
-  int switch_id; // id of the switch node
+  /**
+   * Compute the id of the link connecting from an npu to the switch.
+   * @param npu_id
+   * @return link id
+   */
+  LinkId inputLinkId(NpuId npu_id) const noexcept;
+
+  /**
+   * Compute the id of the link connecting from the switch to an npu.
+   * @param npu_id
+   * @return link id
+   */
+  LinkId outputLinkId(NpuId npu_id) const noexcept;
+
+  int switch_id; // id of the switch node (= number of npus)
 };
 } // namespace Analytical
 
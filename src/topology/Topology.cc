@@ -4,55 +4,360 @@ LICENSE file in the root directory of this source tree.
 *******************************************************************************/
 
 #include "Topology.hh"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <tuple>
+#include <utility>
 
 using namespace Analytical;
 
 void Topology::connect(NpuId src_id, NpuId dest_id, int dimension) noexcept {
   assert(
-      (dimension < configurations.size()) &&
+      (dimension >= 0 && dimension < (int)configurations.size()) &&
       "[Topology, method connect] dimension out of bound");
   assert(src_id >= 0 && "[Topology, method connect] srcId is negative");
   assert(src_id >= 0 && "[Topology, method connect] destId is negative");
 
+  assert(
+      link_offsets.empty() &&
+      "[Topology, method connect] links are already built");
+
   auto configuration = configurations[dimension];
 
   auto link_latency = configuration.getLinkLatency();
+  auto link_bandwidth = configuration.getEffectiveLinkBandwidth();
+
+  connections.push_back({src_id, dest_id, Link(link_latency, link_bandwidth)});
+}
+
+void Topology::buildLinks() noexcept {
+  assert(
+      link_offsets.empty() &&
+      "[Topology, method buildLinks] links are already built");
+
+  // sort by (src, dest), keeping the latest connection of each pair last
+  std::stable_sort(
+      connections.begin(),
+      connections.end(),
+      [](const Connection& a, const Connection& b) {
+        return std::tie(a.src_id, a.dest_id) < std::tie(b.src_id, b.dest_id);
+      });
+
+  auto nodes_count = 0;
+  for (const auto& connection : connections) {
+    nodes_count = std::max(
+        nodes_count, std::max(connection.src_id, connection.dest_id) + 1);
+  }
+
+  // count outgoing links of each src, then prefix-sum into offsets
+  link_offsets.assign(nodes_count + 1, 0);
+  for (auto i = (size_t)0; i < connections.size(); i++) {
+    const auto& connection = connections[i];
+    if (i + 1 < connections.size() &&
+        connections[i + 1].src_id == connection.src_id &&
+        connections[i + 1].dest_id == connection.dest_id) {
+      // replaced by a later connection
+      continue;
+    }
+    link_offsets[connection.src_id + 1]++;
+    link_dests.push_back(connection.dest_id);
+    links.push_back(connection.link);
+  }
+  for (auto src_id = 0; src_id < nodes_count; src_id++) {
+    link_offsets[src_id + 1] += link_offsets[src_id];
+  }
+
+  connections.clear();
+  connections.shrink_to_fit();
+}
+
+void Topology::declareImplicitLinks(
+    int links_count,
+    int dimension,
+    bool sparse) noexcept {
+  assert(
+      (dimension >= 0 && dimension < (int)configurations.size()) &&
+      "[Topology, method declareImplicitLinks] dimension out of bound");
+  assert(
+      (link_offsets.empty() && links.empty() && connections.empty()) &&
+      "[Topology, method declareImplicitLinks] links are already added");
 
-  links[src_id][dest_id] = Link(link_latency);
+  auto link_latency = configurations[dimension].getLinkLatency();
+  auto link_bandwidth = configurations[dimension].getEffectiveLinkBandwidth();
+
+  if (sparse) {
+    sparse_links_enabled = true;
+    sparse_links_count = links_count;
+    sparse_link_latency = link_latency;
+    sparse_link_bandwidth = link_bandwidth;
+  } else {
+    links.assign(links_count, Link(link_latency, link_bandwidth));
+  }
+}
+
+Topology::LinkId Topology::linkId(NpuId src_id, NpuId dest_id) const noexcept {
+  assert(
+      (src_id >= 0 && src_id + 1 < (int)link_offsets.size()) &&
+      "[Topology, method linkId] src doesn't have any outgoing link");
+
+  // outgoing links of src are sorted by dest
+  auto begin = link_dests.begin() + link_offsets[src_id];
+  auto end = link_dests.begin() + link_offsets[src_id + 1];
+  auto dest = std::lower_bound(begin, end, dest_id);
+  assert(
+      (dest != end && *dest == dest_id) &&
+      "[Topology, method linkId] link src->dest doesn't exist");
+
+  return (LinkId)(dest - link_dests.begin());
 }
 
 Topology::Latency Topology::route(
-    NpuId src_id,
-    NpuId dest_id,
+    LinkId link_id,
     PayloadSize payload_size) noexcept {
+  return findLink(link_id).send(payload_size);
+}
+
+int Topology::addLane(std::vector<LinkId> link_ids) noexcept {
+  lanes.emplace_back(std::move(link_ids));
+  return (int)lanes.size() - 1;
+}
+
+void Topology::recordLaneHops(
+    int lane_id,
+    int start,
+    int hops_count,
+    PayloadSize payload_size) noexcept {
+  assert(
+      (lane_id >= 0 && lane_id < (int)lanes.size()) &&
+      "[Topology, method recordLaneHops] lane doesn't exist");
+  auto& lane = lanes[lane_id];
+  auto had_pending_stats = lane.hasPendingStats();
+  lane.recordHops(start, hops_count, payload_size);
+  if (!had_pending_stats && lane.hasPendingStats()) {
+    pending_lane_ids.push_back(lane_id);
+  }
+}
+
+void Topology::appendLaneHops(
+    int lane_id,
+    int start,
+    int hops_count) noexcept {
+  assert(
+      (lane_id >= 0 && lane_id < (int)lanes.size()) &&
+      "[Topology, method appendLaneHops] lane doesn't exist");
+  if (contention_model == ContentionModel::Queueing) {
+    // estimated per lane segment, whatever its length
+    path_lane_hops.push_back({lane_id, start, hops_count});
+    return;
+  }
+
+  const auto& lane = lanes[lane_id];
+
+  auto position = start;
+  for (auto hop = 0; hop < hops_count; hop++) {
+    path.push_back(lane.getLinkId(position));
+    position = (position + 1) % lane.length();
+  }
+}
+
+Topology::Latency Topology::contendPath(
+    PayloadSize payload_size,
+    int dimension,
+    Latency hop_latency) noexcept {
+  switch (contention_model) {
+    case ContentionModel::Reservation:
+      return reservePath(payload_size, dimension, hop_latency);
+    case ContentionModel::Flow:
+      // the flow network takes path and simulates the sharing
+      path_wire_size = configurations[dimension].wireSize(payload_size);
+      return 0;
+    case ContentionModel::Queueing:
+      return estimatePath(payload_size, dimension, hop_latency);
+    default:
+      path.clear();
+      path_lane_hops.clear();
+      return 0;
+  }
+}
+
+Topology::Latency Topology::reservePath(
+    PayloadSize payload_size,
+    int dimension,
+    Latency hop_latency) noexcept {
+  assert(
+      contention_model == ContentionModel::Reservation &&
+      "[Topology, method reservePath] reservation model is not enabled");
+
+  // a link is busy while the payload is serialized on it
+  auto occupancy_time = serialize(payload_size, dimension);
+
+  auto queueing_delay = (Latency)0;
+  auto arrival_time = current_time + nicLatency(dimension);
+  for (auto link_id : path) {
+    auto start_time = findLink(link_id).reserve(arrival_time, occupancy_time);
+    queueing_delay += start_time - arrival_time;
+    arrival_time = start_time + hop_latency;
+  }
+
+  path.clear();
+  return queueing_delay;
+}
+
+Topology::Latency Topology::estimatePath(
+    PayloadSize payload_size,
+    int dimension,
+    Latency hop_latency) noexcept {
+  assert(
+      contention_model == ContentionModel::Queueing &&
+      "[Topology, method estimatePath] queueing model is not enabled");
+
+  auto occupancy_time = serialize(payload_size, dimension);
+
+  auto queueing_delay = (Latency)0;
+  auto arrival_time = current_time + nicLatency(dimension);
+  for (auto link_id : path) {
+    auto wait = findLink(link_id).estimateWait(
+        arrival_time, occupancy_time, queueing_window);
+    queueing_delay += wait;
+    arrival_time += wait + hop_latency;
+  }
+  for (const auto& lane_hops : path_lane_hops) {
+    auto wait = lanes[lane_hops.lane_id].estimateWait(
+        arrival_time,
+        occupancy_time,
+        lane_hops.start,
+        lane_hops.hops_count,
+        queueing_window);
+    queueing_delay += wait;
+    arrival_time += wait + (lane_hops.hops_count * hop_latency);
+  }
+
+  path.clear();
+  path_lane_hops.clear();
+  return queueing_delay;
+}
+
+void Topology::setContentionModel(ContentionModel contention_model) noexcept {
+  this->contention_model = contention_model;
+}
+
+void Topology::setQueueingWindow(Latency queueing_window) noexcept {
+  assert(
+      queueing_window > 0 &&
+      "[Topology, method setQueueingWindow] window is not positive");
+  this->queueing_window = queueing_window;
+}
+
+void Topology::setSwitchingMode(SwitchingMode switching_mode) noexcept {
+  this->switching_mode = switching_mode;
+}
+
+double Topology::takePath(std::vector<LinkId>& taken_path) noexcept {
   assert(
-      (links.find(src_id) != links.end()) &&
-      "[Topology, method route] src doesn't have any outgoing link");
+      contention_model == ContentionModel::Flow &&
+      "[Topology, method takePath] flow model is not enabled");
+  taken_path.swap(path);
+  path.clear();
+  return path_wire_size;
+}
+
+void Topology::setCurrentTime(Latency current_time) noexcept {
   assert(
-      (links[src_id].find(dest_id) != links[src_id].end()) &&
-      "[Topology, method route] link src->dest doesn't exist");
-  return links[src_id][dest_id].send(payload_size);
+      current_time >= this->current_time &&
+      "[Topology, method setCurrentTime] time goes backward");
+  this->current_time = current_time;
+}
+
+int Topology::linksCount() const noexcept {
+  if (sparse_links_enabled) {
+    return sparse_links_count;
+  }
+  return (int)links.size();
+}
+
+const Link& Topology::getLink(LinkId link_id) noexcept {
+  // add stats accumulated by lanes since the last read
+  for (auto lane_id : pending_lane_ids) {
+    lanes[lane_id].materialize(links);
+  }
+  pending_lane_ids.clear();
+
+  return findLink(link_id);
+}
+
+Topology::Bandwidth Topology::linkBandwidth(LinkId link_id) noexcept {
+  return findLink(link_id).getLinkBandwidth();
+}
+
+Link& Topology::findLink(LinkId link_id) noexcept {
+  assert(
+      (link_id >= 0 && link_id < linksCount()) &&
+      "[Topology, method findLink] link doesn't exist");
+
+  if (!sparse_links_enabled) {
+    return links[link_id];
+  }
+
+  auto link = sparse_links.find(link_id);
+  if (link == sparse_links.end()) {
+    // first use of this link
+    link = sparse_links
+               .emplace(
+                   link_id, Link(sparse_link_latency, sparse_link_bandwidth))
+               .first;
+  }
+  return link->second;
+}
+
+Topology::Latency Topology::route(
+    NpuId src_id,
+    NpuId dest_id,
+    PayloadSize payload_size) noexcept {
+  return route(linkId(src_id, dest_id), payload_size);
 }
 
 Topology::Latency Topology::serialize(PayloadSize payload_size, int dimension)
     const noexcept {
   assert(
-      (dimension < configurations.size()) &&
+      (dimension >= 0 && dimension < (int)configurations.size()) &&
       "[Topology, method serialize] dimension out of bound");
-  return payload_size / configurations[dimension].getLinkBandwidth();
+  return configurations[dimension].serializationTime(payload_size);
+}
+
+Topology::Latency Topology::pipelinedSerialize(
+    PayloadSize payload_size,
+    int dimension,
+    int forwards_count) const noexcept {
+  // the remaining packets are hidden behind the first one at each hop,
+  // except for the full message serialization at the last link
+  return serialize(payload_size, dimension) +
+      (forwards_count * forwardingDelay(payload_size, dimension));
+}
+
+Topology::Latency Topology::forwardingDelay(
+    PayloadSize payload_size,
+    int dimension) const noexcept {
+  if (switching_mode == SwitchingMode::CutThrough) {
+    return 0;
+  }
+
+  // store-and-forward: the first packet is received in full
+  auto mtu = configurations[dimension].getMtu();
+  auto packet_size = (mtu > 0) ? std::min(payload_size, mtu) : payload_size;
+  return serialize(packet_size, dimension);
 }
 
 Topology::Latency Topology::routerLatency(int dimension) const noexcept {
   assert(
-      (dimension < configurations.size()) &&
+      (dimension >= 0 && dimension < (int)configurations.size()) &&
       "[Topology, method routerLatency] dimension out of bound");
   return configurations[dimension].getRouterLatency();
 }
 
 Topology::Latency Topology::nicLatency(int dimension) const noexcept {
   assert(
-      (dimension < configurations.size()) &&
+      (dimension >= 0 && dimension < (int)configurations.size()) &&
       "[Topology, method nicLatency] dimension out of bound");
   return configurations[dimension].getNicLatency();
 }
@@ -60,7 +365,7 @@ Topology::Latency Topology::nicLatency(int dimension) const noexcept {
 Topology::Latency Topology::hbmLatency(PayloadSize payload_size, int dimension)
     const noexcept {
   assert(
-      (dimension < configurations.size()) &&
+      (dimension >= 0 && dimension < (int)configurations.size()) &&
       "[Topology, method hbmLatency] dimension out of bound");
   auto configuration = configurations[dimension];
 
@@ -68,8 +373,9 @@ Topology::Latency Topology::hbmLatency(PayloadSize payload_size, int dimension)
   auto hbm_bandwidth = configuration.getHbmBandwidth();
   auto hbm_scalar = configuration.getHbmScalar();
 
-  auto latency = hbm_latency + (payload_size / hbm_bandwidth);
-  return hbm_scalar * latency;
+  // hbm_latency is in ps, and hbm_bandwidth is in B/ns
+  auto latency = hbm_latency + (payload_size * 1000.0 / hbm_bandwidth);
+  return (Latency)std::llround(hbm_scalar * latency);
 }
 
 Topology::Latency Topology::criticalLatency(
@@ -85,3 +391,13 @@ Topology::Latency Topology::criticalLatency(
   hbm_bounds_count++;
   return hbm_latency;
 }
+
+Topology::Latency Topology::minimumLatency() const noexcept {
+  auto link_latency = configurations[0].getLinkLatency();
+  link_latency += 2 * nicLatency(0);
+
+  // critical latency is never smaller than the hbm latency of an empty payload
+  auto hbm_latency = hbmLatency(0, 0);
+
+  return std::max(link_latency, hbm_latency);
+}
@@ -6,9 +6,10 @@ LICENSE file in the root directory of this source tree.
 #ifndef __TOPOLOGY_HH__
 #define __TOPOLOGY_HH__
 
-#include <map>
+#include <unordered_map>
 #include <vector>
 #include "Link.hh"
+#include "LinkLane.hh"
 #include "TopologyConfiguration.hh"
 
 namespace Analytical {
@@ -20,9 +21,30 @@ class Topology {
   using TopologyConfigurations = TopologyConfiguration::TopologyConfigurations;
 
   using NpuId = int; // Each NPU's ID is in 'int'
+  using LinkId = LinkLane::LinkId; // Index of a link in the link arrays
   using NpuAddress =
       std::vector<int>; // NPU's address, denoted by PackageID of each dimension
 
+  /**
+   * How concurrent packets sharing a link delay each other.
+   *   - None: links are shared for free
+   *   - Reservation: each link is busy while a packet is serialized on it,
+   *     and a packet reaching a busy link queues behind earlier packets
+   *   - Flow: packets are flows sharing link bandwidth max-min fairly,
+   *     simulated by a FlowNetwork (send only reports the path)
+   *   - Queueing: each link adds the M/D/1 mean waiting time under its
+   *     exponentially smoothed offered load (no per-packet reservation)
+   *     (Ring and Torus2D smooth the load per lane of links instead)
+   */
+  enum class ContentionModel { None, Reservation, Flow, Queueing };
+
+  /**
+   * How a packet is forwarded from a link to the next one.
+   *   - CutThrough: forwarding starts as soon as the packet head arrives
+   *   - StoreAndForward: forwarding starts once the whole packet is received
+   */
+  enum class SwitchingMode { CutThrough, StoreAndForward };
+
   /**
    * Simulate packet transmission from src to dest.
    *
@@ -41,6 +63,72 @@ class Topology {
       NpuId dest_id,
       PayloadSize payload_size) noexcept = 0;
 
+  /**
+   * Lower bound of the latency `send` returns between two different NPUs.
+   * By default: one link and two nics of the first dimension, or the HBM
+   * access latency if it is larger.
+   *
+   * @return minimum latency of a transmission
+   */
+  virtual Latency minimumLatency() const noexcept;
+
+  /**
+   * Set the contention model of links (ContentionModel::None by default).
+   * @param contention_model
+   */
+  void setContentionModel(ContentionModel contention_model) noexcept;
+
+  /**
+   * Set the time constant of the offered load smoothing, used by the
+   * queueing contention model.
+   * @param queueing_window time constant (in ps), should be positive
+   */
+  void setQueueingWindow(Latency queueing_window) noexcept;
+
+  /**
+   * Set how packets are forwarded between links
+   * (SwitchingMode::CutThrough by default).
+   * @param switching_mode
+   */
+  void setSwitchingMode(SwitchingMode switching_mode) noexcept;
+
+  /**
+   * Set the time the following packets are sent, used by the contention
+   * model. (Packets should be sent in non-decreasing time order)
+   * @param current_time current time (in ps)
+   */
+  void setCurrentTime(Latency current_time) noexcept;
+
+  /**
+   * Under the Flow contention model, move the links passed by the packet
+   * just sent into taken_path.
+   * @param taken_path vector to move the links into (previous content is
+   *                   discarded)
+   * @return wire size (in bytes) of the packet, with framing overheads
+   */
+  double takePath(std::vector<LinkId>& taken_path) noexcept;
+
+  /**
+   * @return number of links
+   */
+  int linksCount() const noexcept;
+
+  /**
+   * Get a link, with up-to-date stats.
+   * (Only lanes recorded since the last call are materialized, so
+   * repeated calls cost O(1))
+   * @param link_id
+   * @return link
+   */
+  const Link& getLink(LinkId link_id) noexcept;
+
+  /**
+   * Get the bandwidth of a link, without updating link stats.
+   * @param link_id
+   * @return link bandwidth
+   */
+  Bandwidth linkBandwidth(LinkId link_id) noexcept;
+
  protected:
   // functions that should be implemented
   /**
@@ -60,8 +148,50 @@ class Topology {
   // members
   TopologyConfigurations
       configurations; // topology configuration for each dimension
-  std::map<NpuId, std::map<NpuId, Link>>
-      links; // links[src][dest] returns a link connecting two links
+
+  /**
+   * Links in compressed sparse row layout, built by buildLinks():
+   * outgoing links of src are [link_offsets[src], link_offsets[src + 1]),
+   * sorted by dest, and link_dests[link_id] is the dest of link link_id.
+   */
+  std::vector<LinkId> link_offsets;
+  std::vector<NpuId> link_dests;
+  std::vector<Link> links; // links[link_id]
+
+  ContentionModel contention_model = ContentionModel::None;
+  SwitchingMode switching_mode = SwitchingMode::CutThrough;
+  Latency current_time = 0; // time the packet being sent is sent
+  Latency queueing_window = 10000000; // offered load time constant (in ps)
+
+  /**
+   * Links passed by the packet being sent, in order.
+   * (Only filled under a contention model)
+   */
+  std::vector<LinkId> path;
+  double path_wire_size = 0; // wire size of the packet, kept for takePath
+
+  /**
+   * Consecutive links of a lane passed by a packet.
+   */
+  struct LaneHops {
+    int lane_id;
+    int start; // position of the first link passed
+    int hops_count; // number of links passed
+  };
+
+  /**
+   * Lane segments passed by the packet being sent, in order, after the
+   * links of path. (Only filled under the queueing contention model)
+   */
+  std::vector<LaneHops> path_lane_hops;
+
+  /**
+   * Lanes of consecutive links, whose stats are accumulated by range
+   * updates and added into links when read.
+   */
+  std::vector<LinkLane> lanes;
+  std::vector<int> pending_lane_ids; // lanes with stats not materialized yet
+
   int communication_bounds_count =
       0; // the number of occasions link_latency was larger
   int hbm_bounds_count = 0; // the number of occasions hbm_latency was larger
@@ -69,12 +199,125 @@ class Topology {
   // helper functions that are already implemented
   /**
    * Add a link connecting from src to dest.
+   * (Connecting the same src and dest again replaces the link)
    * @param src_id
    * @param dest_id
    * @param dimension dimension of the link
    */
   void connect(NpuId src_id, NpuId dest_id, int dimension) noexcept;
 
+  /**
+   * Pack the links added by connect into the link arrays.
+   * Should be called once, after the last connect.
+   */
+  void buildLinks() noexcept;
+
+  /**
+   * Declare links whose ids are computed by the topology itself, instead
+   * of connect and buildLinks. Link ids are [0, links_count).
+   * @param links_count number of links
+   * @param dimension dimension of the links
+   * @param sparse if true, a link is only allocated the first time it is
+   *               used; otherwise every link is allocated up front
+   */
+  void declareImplicitLinks(int links_count, int dimension, bool sparse)
+      noexcept;
+
+  /**
+   * Find the link connecting from src to dest.
+   * src and dest must be connected.
+   * @param src_id
+   * @param dest_id
+   * @return id of the src->dest link
+   */
+  LinkId linkId(NpuId src_id, NpuId dest_id) const noexcept;
+
+  /**
+   * Send a packet through a link, and return the latency.
+   * @param link_id
+   * @param payload_size
+   * @return latency of the transmission over the link
+   */
+  Latency route(LinkId link_id, PayloadSize payload_size) noexcept;
+
+  /**
+   * Add a lane of consecutive links.
+   * @param link_ids link at each position of the lane
+   * @return lane id
+   */
+  int addLane(std::vector<LinkId> link_ids) noexcept;
+
+  /**
+   * Update stats of the consecutive links of a lane passed by a packet,
+   * without computing latency.
+   * (For topologies computing path latencies in closed form)
+   * @param lane_id
+   * @param start position of the first link passed
+   * @param hops_count number of links passed
+   * @param payload_size
+   */
+  void recordLaneHops(
+      int lane_id,
+      int start,
+      int hops_count,
+      PayloadSize payload_size) noexcept;
+
+  /**
+   * Append the consecutive links of a lane passed by a packet to path
+   * (to path_lane_hops instead under the queueing contention model, which
+   * estimates them at once).
+   * @param lane_id
+   * @param start position of the first link passed
+   * @param hops_count number of links passed
+   */
+  void appendLaneHops(int lane_id, int start, int hops_count) noexcept;
+
+  /**
+   * Apply the contention model to the packet passing the links of path.
+   *   - Reservation: reserve the links (see reservePath)
+   *   - Flow: keep path for the flow network (see takePath)
+   *   - Queueing: estimate the queueing delay (see estimatePath)
+   * @param payload_size
+   * @param dimension dimension of the links
+   * @param hop_latency latency between two consecutive links of path
+   * @return queueing delay of the packet
+   */
+  Latency contendPath(
+      PayloadSize payload_size,
+      int dimension,
+      Latency hop_latency) noexcept;
+
+  /**
+   * Reserve the links of path in order, under the contention model,
+   * and compute the queueing delay of the packet. The packet reaches the
+   * first link after the nic latency, and each following link hop_latency
+   * after it starts passing the previous one.
+   * @param payload_size
+   * @param dimension dimension of the links
+   * @param hop_latency latency between two consecutive links of path
+   * @return queueing delay of the packet
+   */
+  Latency reservePath(
+      PayloadSize payload_size,
+      int dimension,
+      Latency hop_latency) noexcept;
+
+  /**
+   * Estimate the queueing delay of the packet on each link of path from
+   * the offered load of the link, and add the packet to the load.
+   * Links are reached as in reservePath. Then estimate the delay over
+   * each lane segment of path_lane_hops from the offered load of its lane
+   * (see LinkLane::estimateWait), in constant time per segment.
+   * @param payload_size
+   * @param dimension dimension of the links
+   * @param hop_latency latency between two consecutive links of path
+   * @return queueing delay of the packet
+   */
+  Latency estimatePath(
+      PayloadSize payload_size,
+      int dimension,
+      Latency hop_latency) noexcept;
+
   /**
    * Send a packet from src to dest, and return the latency.
    * src and dest must be connected.
@@ -92,6 +335,36 @@ class Topology {
    */
   Latency serialize(PayloadSize payload_size, int dimension) const noexcept;
 
+  /**
+   * Simulate the serialization delay of a message split into packets of
+   * at most mtu bytes, pipelined over a path: the first packet passes
+   * every hop, then the remaining packets follow it back to back.
+   *   - CutThrough: the head of the first packet cuts through each hop,
+   *     so the delay is serialize(payload_size) whatever the mtu
+   *   - StoreAndForward: the first packet is also serialized again at
+   *     each of the forwards_count forwarding points
+   * @param payload_size
+   * @param dimension dimension to use
+   * @param forwards_count number of times packets are forwarded from a
+   *                       link to the next one (links passed - 1)
+   * @return serialization delay
+   */
+  Latency pipelinedSerialize(
+      PayloadSize payload_size,
+      int dimension,
+      int forwards_count) const noexcept;
+
+  /**
+   * Simulate the delay a packet of the message waits at each forwarding
+   * point before it is forwarded.
+   * @param payload_size
+   * @param dimension dimension to use
+   * @return serialization delay of the first packet under StoreAndForward,
+   *         0 under CutThrough
+   */
+  Latency forwardingDelay(PayloadSize payload_size, int dimension)
+      const noexcept;
+
   /**
    * Simulate router latency.
    * @param dimension dimension of the router
@@ -121,6 +394,36 @@ class Topology {
    * @return larger latency
    */
   Latency criticalLatency(Latency link_latency, Latency hbm_latency) noexcept;
+
+ private:
+  /**
+   * Find a link, allocating it if it is a sparse link used for the first
+   * time.
+   * @param link_id
+   * @return link
+   */
+  Link& findLink(LinkId link_id) noexcept;
+
+  /**
+   * Link added by connect, waiting for buildLinks.
+   */
+  struct Connection {
+    NpuId src_id;
+    NpuId dest_id;
+    Link link;
+  };
+
+  std::vector<Connection> connections; // links not packed yet
+
+  /**
+   * Sparse implicit links (see declareImplicitLinks):
+   * only the links used so far, instead of links
+   */
+  bool sparse_links_enabled = false;
+  int sparse_links_count = 0;
+  Latency sparse_link_latency = 0;
+  Bandwidth sparse_link_bandwidth = 0;
+  std::unordered_map<LinkId, Link> sparse_links;
 };
 } // namespace Analytical
 
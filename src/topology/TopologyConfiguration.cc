@@ -4,24 +4,73 @@ LICENSE file in the root directory of this source tree.
 *******************************************************************************/
 
 #include "TopologyConfiguration.hh"
+#include <algorithm>
+#include <cmath>
 
 using namespace Analytical;
 
 TopologyConfiguration::TopologyConfiguration(
-    Latency link_latency,
+    double link_latency,
     Bandwidth link_bandwidth,
-    Latency nic_latency,
-    Latency router_latency,
-    Latency hbm_latency,
+    double nic_latency,
+    double router_latency,
+    double hbm_latency,
     Bandwidth hbm_bandwidth,
-    double hbm_scalar) noexcept
-    : link_latency(link_latency),
+    double hbm_scalar,
+    PayloadSize mtu,
+    PayloadSize header_size,
+    double coding_efficiency,
+    PayloadSize min_frame_size) noexcept
+    : link_latency(nsToPs(link_latency)),
       link_bandwidth(link_bandwidth),
-      nic_latency(nic_latency),
-      router_latency(router_latency),
-      hbm_latency(hbm_latency),
+      nic_latency(nsToPs(nic_latency)),
+      router_latency(nsToPs(router_latency)),
+      hbm_latency(nsToPs(hbm_latency)),
       hbm_bandwidth(hbm_bandwidth),
-      hbm_scalar(hbm_scalar) {}
+      hbm_scalar(hbm_scalar),
+      mtu(mtu),
+      header_size(header_size),
+      coding_efficiency(coding_efficiency),
+      min_frame_size(min_frame_size) {}
+
+TopologyConfiguration::Latency TopologyConfiguration::nsToPs(
+    double latency_ns) noexcept {
+  return (Latency)std::llround(latency_ns * 1000);
+}
+
+TopologyConfiguration::Latency TopologyConfiguration::transferTime(
+    double payload_size,
+    Bandwidth bandwidth) noexcept {
+  // bandwidth is in B/ns: (payload_size / bandwidth) ns
+  return nsToPs(payload_size / bandwidth);
+}
+
+double TopologyConfiguration::wireSize(PayloadSize payload_size)
+    const noexcept {
+  // a payload is sent as full packets and one last (possibly partial) one;
+  // even an empty payload takes a frame
+  auto full_packets_count = 0;
+  auto last_packet_size = payload_size;
+  if (mtu > 0 && payload_size > 0) {
+    full_packets_count = (payload_size - 1) / mtu;
+    last_packet_size = payload_size - (full_packets_count * mtu);
+  }
+
+  auto full_frame_size = (double)std::max(mtu + header_size, min_frame_size);
+  auto last_frame_size =
+      (double)std::max(last_packet_size + header_size, min_frame_size);
+  return (full_packets_count * full_frame_size) + last_frame_size;
+}
+
+TopologyConfiguration::Latency TopologyConfiguration::serializationTime(
+    PayloadSize payload_size) const noexcept {
+  return transferTime(wireSize(payload_size), getEffectiveLinkBandwidth());
+}
+
+TopologyConfiguration::Bandwidth
+TopologyConfiguration::getEffectiveLinkBandwidth() const noexcept {
+  return link_bandwidth * coding_efficiency;
+}
 
 TopologyConfiguration::Latency TopologyConfiguration::getLinkLatency()
     const noexcept {
@@ -56,3 +105,22 @@ TopologyConfiguration::Bandwidth TopologyConfiguration::getHbmBandwidth()
 double TopologyConfiguration::getHbmScalar() const noexcept {
   return hbm_scalar;
 }
+
+TopologyConfiguration::PayloadSize TopologyConfiguration::getMtu()
+    const noexcept {
+  return mtu;
+}
+
+TopologyConfiguration::PayloadSize TopologyConfiguration::getHeaderSize()
+    const noexcept {
+  return header_size;
+}
+
+double TopologyConfiguration::getCodingEfficiency() const noexcept {
+  return coding_efficiency;
+}
+
+TopologyConfiguration::PayloadSize TopologyConfiguration::getMinFrameSize()
+    const noexcept {
+  return min_frame_size;
+}
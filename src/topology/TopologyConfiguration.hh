@@ -6,26 +6,78 @@ LICENSE file in the root directory of this source tree.
 #ifndef __TOPOLOGYCONFIGURATION_HH__
 #define __TOPOLOGYCONFIGURATION_HH__
 
+#include <cstdint>
 #include <vector>
 
 namespace Analytical {
 struct TopologyConfiguration {
  public:
-  using Latency = double; // latency in ns
+  using Latency = uint64_t; // latency in ps
   using Bandwidth = double; // bandwidth in GB/s (= B/ns)
   using PayloadSize = int; // payload size in bytes
   using TopologyConfigurations =
       std::vector<TopologyConfiguration>; // Topology configurations for each
                                           // dimension
 
+  /**
+   * Construct a configuration of a dimension.
+   * (latencies are given in ns, and stored in ps)
+   * mtu is the largest packet payload (in bytes) messages are split into,
+   * 0 if messages are not packetized. Each packet is framed with
+   * header_size bytes, padded to min_frame_size bytes, and encoded on the
+   * link at coding_efficiency (e.g., 128/130) of the link bandwidth.
+   */
   TopologyConfiguration(
-      Latency link_latency,
+      double link_latency,
       Bandwidth link_bandwidth,
-      Latency nic_latency,
-      Latency router_latency,
-      Latency hbm_latency,
+      double nic_latency,
+      double router_latency,
+      double hbm_latency,
       Bandwidth hbm_bandwidth,
-      double hbm_scalar) noexcept;
+      double hbm_scalar,
+      PayloadSize mtu,
+      PayloadSize header_size,
+      double coding_efficiency,
+      PayloadSize min_frame_size) noexcept;
+
+  /**
+   * Convert a latency in ns into ps, rounded to the nearest ps.
+   * @param latency_ns latency in ns
+   * @return latency in ps
+   */
+  static Latency nsToPs(double latency_ns) noexcept;
+
+  /**
+   * Compute the time to transfer payload_size bytes at given bandwidth,
+   * rounded to the nearest ps.
+   * @param payload_size payload size in bytes
+   * @param bandwidth bandwidth in GB/s (= B/ns)
+   * @return transfer time in ps
+   */
+  static Latency transferTime(
+      double payload_size,
+      Bandwidth bandwidth) noexcept;
+
+  /**
+   * Compute the number of bytes a payload takes on the wire: the frames
+   * of its packets, with their headers and padding.
+   * @param payload_size payload size in bytes
+   * @return wire size in bytes
+   */
+  double wireSize(PayloadSize payload_size) const noexcept;
+
+  /**
+   * Compute the time to serialize a payload on a link of this dimension,
+   * from the wire size and the effective link bandwidth.
+   * @param payload_size payload size in bytes
+   * @return serialization time in ps
+   */
+  Latency serializationTime(PayloadSize payload_size) const noexcept;
+
+  /**
+   * @return link bandwidth left after line coding (in GB/s = B/ns)
+   */
+  Bandwidth getEffectiveLinkBandwidth() const noexcept;
 
   Latency getLinkLatency() const noexcept;
   Bandwidth getLinkBandwidth() const noexcept;
@@ -34,6 +86,10 @@ struct TopologyConfiguration {
   Latency getHbmLatency() const noexcept;
   Bandwidth getHbmBandwidth() const noexcept;
   double getHbmScalar() const noexcept;
+  PayloadSize getMtu() const noexcept;
+  PayloadSize getHeaderSize() const noexcept;
+  double getCodingEfficiency() const noexcept;
+  PayloadSize getMinFrameSize() const noexcept;
 
  private:
   Latency link_latency;
@@ -43,6 +99,10 @@ struct TopologyConfiguration {
   Latency hbm_latency;
   Bandwidth hbm_bandwidth;
   double hbm_scalar;
+  PayloadSize mtu;
+  PayloadSize header_size;
+  double coding_efficiency;
+  PayloadSize min_frame_size;
 };
 } // namespace Analytical
 
@@ -55,6 +55,39 @@ Torus2D::Torus2D(
     connect(n1, n2, 0);
     connect(n2, n1, 0);
   }
+
+  // pack links into the link arrays
+  buildLinks();
+
+  // lanes of links, in the order packets pass them
+  for (auto index = 0; index < width; index++) {
+    auto right_links = std::vector<LinkId>();
+    auto left_links = std::vector<LinkId>();
+    auto up_links = std::vector<LinkId>();
+    auto down_links = std::vector<LinkId>();
+
+    for (auto position = 0; position < width; position++) {
+      // npu passed at this position, and its neighbors
+      auto current = position;
+      auto reversed = width - 1 - position;
+      auto next = (current + 1) % width;
+      auto previous = (reversed + width - 1) % width;
+
+      right_links.push_back(
+          linkId(rowColToId(index, current), rowColToId(index, next)));
+      left_links.push_back(
+          linkId(rowColToId(index, reversed), rowColToId(index, previous)));
+      up_links.push_back(
+          linkId(rowColToId(current, index), rowColToId(next, index)));
+      down_links.push_back(
+          linkId(rowColToId(reversed, index), rowColToId(previous, index)));
+    }
+
+    right_lanes.push_back(addLane(std::move(right_links)));
+    left_lanes.push_back(addLane(std::move(left_links)));
+    up_lanes.push_back(addLane(std::move(up_links)));
+    down_lanes.push_back(addLane(std::move(down_links)));
+  }
 }
 
 Topology::Latency Torus2D::send(
@@ -74,43 +107,40 @@ Topology::Latency Torus2D::send(
   auto dest_col = -1;
   std::tie(dest_row, dest_col) = idToRowCol(dest_id);
 
-  // serialize
-  auto link_latency = serialize(payload_size, 0);
-  link_latency += nicLatency(0);
+  auto link_latency = nicLatency(0);
 
-  // xy routing
+  // xy routing: every link of the torus has the same latency
+  auto hops_count = 0;
 
   if (src_col != dest_col) {
     // should move x direction (i.e., move within row)
     auto direction = computeDirection(src_col, dest_col);
-
-    auto current_col = src_col;
-    while (current_col != dest_col) {
-      auto next_col = takeStep(current_col, direction);
-
-      auto current_id = rowColToId(src_row, current_col);
-      auto next_id = rowColToId(src_row, next_col);
-      link_latency += route(current_id, next_id, payload_size);
-
-      current_col = next_col;
-    }
+    auto row_hops_count = hopsCount(src_col, dest_col, direction);
+    recordRowHops(src_row, src_col, direction, row_hops_count, payload_size);
+    hops_count += row_hops_count;
   }
 
   if (src_row != dest_row) {
     // should move y direction (i.e., move within column)
-    // should move x direction (i.e., move within row)
     auto direction = computeDirection(src_row, dest_row);
+    auto column_hops_count = hopsCount(src_row, dest_row, direction);
+    recordColumnHops(
+        dest_col, src_row, direction, column_hops_count, payload_size);
+    hops_count += column_hops_count;
+  }
 
-    auto current_row = src_row;
-    while (current_row != dest_row) {
-      auto next_row = takeStep(current_row, direction);
+  link_latency += hops_count * configurations[0].getLinkLatency();
 
-      auto current_id = rowColToId(current_row, dest_col);
-      auto next_id = rowColToId(next_row, dest_col);
-      link_latency += route(current_id, next_id, payload_size);
+  // serialize packets, pipelined over the path
+  link_latency += pipelinedSerialize(payload_size, 0, hops_count - 1);
 
-      current_row = next_row;
-    }
+  if (contention_model != ContentionModel::None) {
+    // contend with other packets on the links passed
+    link_latency += contendPath(
+        payload_size,
+        0,
+        configurations[0].getLinkLatency() +
+            forwardingDelay(payload_size, 0));
   }
 
   link_latency += nicLatency(0);
@@ -150,17 +180,39 @@ Torus2D::NpuId Torus2D::rowColToId(int row, int column) const noexcept {
   return (row * width) + column;
 }
 
-int Torus2D::takeStep(int current_index, Direction direction) const noexcept {
-  // compute next id of the ring
-  auto next_index = current_index + direction;
+int Torus2D::hopsCount(int src_index, int dest_index, Direction direction)
+    const noexcept {
+  auto distance =
+      (direction > 0) ? (dest_index - src_index) : (src_index - dest_index);
+  return (distance + width) % width;
+}
+
+void Torus2D::recordRowHops(
+    int row,
+    int src_col,
+    Direction direction,
+    int hops_count,
+    PayloadSize payload_size) noexcept {
+  auto lane_id = (direction > 0) ? right_lanes[row] : left_lanes[row];
+  auto start = (direction > 0) ? src_col : (width - 1 - src_col);
 
-  if (next_index >= width) {
-    // out of positive bounds
-    next_index %= width;
-  } else if (next_index < 0) {
-    // out of negative bounds
-    next_index = width + (next_index % width);
+  recordLaneHops(lane_id, start, hops_count, payload_size);
+  if (contention_model != ContentionModel::None) {
+    appendLaneHops(lane_id, start, hops_count);
   }
+}
 
-  return next_index;
+void Torus2D::recordColumnHops(
+    int col,
+    int src_row,
+    Direction direction,
+    int hops_count,
+    PayloadSize payload_size) noexcept {
+  auto lane_id = (direction > 0) ? up_lanes[col] : down_lanes[col];
+  auto start = (direction > 0) ? src_row : (width - 1 - src_row);
+
+  recordLaneHops(lane_id, start, hops_count, payload_size);
+  if (contention_model != ContentionModel::None) {
+    appendLaneHops(lane_id, start, hops_count);
+  }
 }
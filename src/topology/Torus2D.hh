@@ -65,13 +65,63 @@ class Torus2D : public Topology {
   NpuId rowColToId(int row, int column) const noexcept;
 
   /**
-   * Compute the next index after taking a single step towards direction.
+   * Count the hops from src_index to dest_index, moving towards the given
+   * direction.
    *
-   * @param current_index
+   * @param src_index
+   * @param dest_index
    * @param direction direction to move
-   * @return next_index after taking a step
+   * @return number of hops
+   */
+  int hopsCount(int src_index, int dest_index, Direction direction)
+      const noexcept;
+
+  /**
+   * Update stats of the links passed by a packet moving within a row,
+   * by a range update into the lane of its direction. Under a contention
+   * model, the links are also appended to path.
+   *
+   * @param row row the packet moves within
+   * @param src_col column the packet starts from
+   * @param direction direction the packet moves
+   * @param hops_count number of hops the packet takes
+   * @param payload_size
+   */
+  void recordRowHops(
+      int row,
+      int src_col,
+      Direction direction,
+      int hops_count,
+      PayloadSize payload_size) noexcept;
+
+  /**
+   * Update stats of the links passed by a packet moving within a column,
+   * by a range update into the lane of its direction. Under a contention
+   * model, the links are also appended to path.
+   *
+   * @param col column the packet moves within
+   * @param src_row row the packet starts from
+   * @param direction direction the packet moves
+   * @param hops_count number of hops the packet takes
+   * @param payload_size
+   */
+  void recordColumnHops(
+      int col,
+      int src_row,
+      Direction direction,
+      int hops_count,
+      PayloadSize payload_size) noexcept;
+
+  /**
+   * Lane ids of each direction, indexed by row (right, left) or by column
+   * (up, down). Position i of a lane is the link leaving:
+   *   - right: (row, i), left: (row, width - 1 - i)
+   *   - up: (i, col), down: (width - 1 - i, col)
    */
-  int takeStep(int current_index, Direction direction) const noexcept;
+  std::vector<int> right_lanes;
+  std::vector<int> left_lanes;
+  std::vector<int> up_lanes;
+  std::vector<int> down_lanes;
 };
 } // namespace Analytical
 
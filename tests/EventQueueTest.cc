@@ -0,0 +1,199 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include <cstdio>
+#include <vector>
+#include "event-queue/EventQueue.hh"
+
+/**
+ * Tests of EventQueue bounded stepping (run_until, run_events, advance_to),
+ * event handles, and tie-break keys.
+ *
+ * Usage: AnalyticalEventQueueTest (exits with 1 if any check fails)
+ */
+
+namespace {
+using Analytical::Event;
+using Analytical::EventHandle;
+using Analytical::EventKey;
+using Analytical::EventQueue;
+using Analytical::TimeStamp;
+
+/**
+ * number of failed checks
+ */
+int failures_count = 0;
+
+void check(bool condition, const char* description) {
+  if (!condition) {
+    std::printf("FAILED: %s\n", description);
+    failures_count++;
+  }
+}
+
+/**
+ * Events log the time they run at.
+ */
+struct Log {
+  EventQueue* event_queue;
+  std::vector<TimeStamp> times;
+
+  Event log_event() {
+    return Event([this]() { times.push_back(event_queue->get_current_time()); });
+  }
+};
+
+void test_run_until(EventQueue::SchedulerType scheduler_type) {
+  auto event_queue = EventQueue(scheduler_type);
+  auto log = Log{&event_queue, {}};
+  for (auto time_stamp : {10, 20, 20, 30, 40}) {
+    event_queue.add_event(time_stamp, log.log_event());
+  }
+
+  // end_time is exclusive
+  check(event_queue.run_until(30) == 3, "run_until runs events before end");
+  check(log.times.size() == 3, "run_until leaves events at end pending");
+  check(
+      event_queue.get_current_time() == 20,
+      "run_until leaves current_time at the last event run");
+  check(event_queue.next_event_time() == 30, "next event is at end_time");
+
+  // events can still be added before end_time
+  event_queue.add_event(25, log.log_event());
+  check(event_queue.run_until(31) == 2, "run_until runs events added later");
+  check(
+      log.times == std::vector<TimeStamp>({10, 20, 20, 25, 30}),
+      "run_until runs events in time order");
+
+  // events scheduled by running events before end_time also run
+  event_queue.add_event(35, Event([&event_queue, &log]() {
+                          event_queue.add_event(36, log.log_event());
+                          event_queue.add_event(50, log.log_event());
+                        }));
+  check(event_queue.run_until(40) == 2, "run_until runs chained events");
+  check(log.times.back() == 36, "chained event before end_time ran");
+  check(event_queue.run_until(1000) == 2, "run_until drains the queue");
+  check(event_queue.empty(), "event queue is drained");
+}
+
+void test_run_events(EventQueue::SchedulerType scheduler_type) {
+  auto event_queue = EventQueue(scheduler_type);
+  auto log = Log{&event_queue, {}};
+  for (auto time_stamp : {10, 20, 20, 20, 30}) {
+    event_queue.add_event(time_stamp, log.log_event());
+  }
+
+  check(event_queue.run_events(1) == 1, "run_events runs one time_stamp");
+  check(
+      event_queue.run_events(2) == 3,
+      "run_events runs every event sharing a time_stamp");
+  check(event_queue.get_current_time() == 20, "run_events stops at 20");
+  check(event_queue.run_events(0) == 0, "run_events(0) runs nothing");
+  check(event_queue.run_events(100) == 1, "run_events stops when empty");
+  check(event_queue.empty(), "event queue is drained");
+}
+
+void test_advance_to(EventQueue::SchedulerType scheduler_type) {
+  auto event_queue = EventQueue(scheduler_type);
+  auto log = Log{&event_queue, {}};
+  event_queue.add_event(10, log.log_event());
+  event_queue.add_event(50, log.log_event());
+
+  // advance to a sync point without any event
+  check(event_queue.advance_to(30) == 1, "advance_to runs earlier events");
+  check(event_queue.get_current_time() == 30, "advance_to moves the clock");
+  check(event_queue.next_event_time() == 50, "later event still pending");
+
+  // events are now added relative to the sync point
+  event_queue.add_event(30, log.log_event());
+  event_queue.add_event(40, log.log_event());
+  check(event_queue.run_until(45) == 2, "events from the sync point run");
+  check(
+      log.times == std::vector<TimeStamp>({10, 30, 40}),
+      "events from the sync point run at their time");
+
+  // advance to the time of a pending event: it runs before later additions
+  auto order = std::vector<int>();
+  event_queue.add_event(60, Event([&order]() { order.push_back(1); }));
+  check(event_queue.advance_to(60) == 1, "advance_to runs the event at 50");
+  check(event_queue.get_current_time() == 60, "advance_to reaches 60");
+  event_queue.add_event(60, Event([&order]() { order.push_back(2); }));
+  check(event_queue.run_until(61) == 2, "both events at 60 run");
+  check(
+      order == std::vector<int>({1, 2}),
+      "events pending at the sync point run first");
+  check(event_queue.empty(), "event queue is drained");
+}
+
+void test_handles(EventQueue::SchedulerType scheduler_type) {
+  auto event_queue = EventQueue(scheduler_type);
+  auto log = Log{&event_queue, {}};
+  auto cancelled = event_queue.add_event(10, log.log_event());
+  auto moved = event_queue.add_event(20, log.log_event());
+
+  check(event_queue.cancel_event(cancelled), "cancel a pending event");
+  check(!event_queue.is_pending(cancelled), "cancelled event not pending");
+  moved = event_queue.reschedule_event(moved, 5);
+  check(event_queue.next_event_time() == 5, "rescheduled event is next");
+
+  // empty events are never scheduled
+  auto empty = event_queue.add_event(15, Event());
+  check(!event_queue.is_pending(empty), "empty event not pending");
+
+  check(event_queue.run_until(1000) == 1, "only the moved event runs");
+  check(!event_queue.is_pending(moved), "ran event not pending");
+  check(event_queue.empty(), "event queue is drained");
+}
+void test_keys(EventQueue::SchedulerType scheduler_type) {
+  auto event_queue = EventQueue(scheduler_type);
+  auto order = std::vector<int>();
+  auto log_event = [&order](int id) {
+    return Event([&order, id]() { order.push_back(id); });
+  };
+
+  // events sharing a time_stamp run in key order, not in adding order
+  event_queue.add_event(10, log_event(1), {0, 2, 0});
+  event_queue.add_event(10, log_event(2), {0, 1, 5});
+  event_queue.add_event(10, log_event(3), {0, 1, 4});
+  auto moved = event_queue.add_event(20, log_event(4), {0, 0, 0});
+  auto cancelled = event_queue.add_event(10, log_event(5), {0, 0, 1});
+  auto cancelling_event =
+      Event([&event_queue, &order, &cancelled, &log_event]() {
+        order.push_back(6);
+        event_queue.cancel_event(cancelled);
+        // zero-delay events run after, in adding order
+        event_queue.add_event(10, log_event(7), {0, 9, 0});
+        event_queue.add_event(10, log_event(8), {0, 0, 0});
+      });
+  event_queue.add_event(10, cancelling_event, {0, 0, 0});
+
+  // a rescheduled event keeps its key
+  event_queue.reschedule_event(moved, 10);
+
+  check(event_queue.run_until(11) == 7, "events at 10 run");
+  check(
+      order == std::vector<int>({6, 4, 3, 2, 1, 7, 8}),
+      "events at 10 run in key order, then zero-delay ones");
+  check(event_queue.empty(), "event queue is drained");
+}
+} // namespace
+
+int main() {
+  for (auto scheduler_type :
+       {EventQueue::SchedulerType::List, EventQueue::SchedulerType::Heap}) {
+    test_run_until(scheduler_type);
+    test_run_events(scheduler_type);
+    test_advance_to(scheduler_type);
+    test_handles(scheduler_type);
+    test_keys(scheduler_type);
+  }
+
+  if (failures_count > 0) {
+    std::printf("%d check(s) failed\n", failures_count);
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}
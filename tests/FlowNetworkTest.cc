@@ -0,0 +1,151 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include "flow/FlowNetwork.hh"
+#include "topology/AllToAll.hh"
+
+/**
+ * Tests of FlowNetwork max-min fair rates, observed through the drain
+ * times of flows sharing a bottleneck.
+ *
+ * Usage: AnalyticalFlowNetworkTest (exits with 1 if any check fails)
+ */
+
+namespace {
+using Analytical::AllToAll;
+using Analytical::Event;
+using Analytical::EventQueue;
+using Analytical::FlowNetwork;
+using Analytical::TimeStamp;
+using Analytical::TopologyConfiguration;
+
+/**
+ * number of failed checks
+ */
+int failures_count = 0;
+
+void check(bool condition, const char* description) {
+  if (!condition) {
+    std::printf("FAILED: %s\n", description);
+    failures_count++;
+  }
+}
+
+/**
+ * link bandwidth (in B/ns), and size (in B) of a flow taking 1 us alone
+ */
+constexpr double bandwidth = 25;
+constexpr double size = 25000;
+
+/**
+ * Flows over the links of an AllToAll topology (used as independent links
+ * of the same bandwidth), logging their drain times.
+ */
+struct Network {
+  std::shared_ptr<EventQueue> event_queue;
+  std::shared_ptr<FlowNetwork> flow_network;
+  std::vector<TimeStamp> drain_times;
+
+  Network() {
+    auto configuration = TopologyConfiguration(
+        1, bandwidth, 0, 0, 0, 1000000, 1, 0, 0, 1, 0);
+    auto topology = std::make_shared<AllToAll>(
+        TopologyConfiguration::TopologyConfigurations{configuration}, 4);
+    event_queue = std::make_shared<EventQueue>();
+    flow_network = std::make_shared<FlowNetwork>(event_queue, topology);
+  }
+
+  void start_flow(int flow_id, const std::vector<int>& path, double size) {
+    drain_times.resize(flow_id + 1, 0);
+    flow_network->start_flow(path, size, Event([this, flow_id]() {
+                               drain_times[flow_id] =
+                                   event_queue->get_current_time();
+                             }));
+  }
+
+  void run() {
+    while (!event_queue->empty()) {
+      event_queue->proceed();
+    }
+  }
+};
+
+/**
+ * @return whether a drain time (in ps) is us microseconds, up to rounding
+ */
+bool drains_at(TimeStamp drain_time, double us) {
+  return std::llabs((long long)drain_time - std::llround(us * 1000000)) <= 2;
+}
+
+void test_lone_flow() {
+  auto network = Network();
+  network.start_flow(0, {0, 1, 2}, size);
+  network.run();
+  check(drains_at(network.drain_times[0], 1), "lone flow gets the bandwidth");
+}
+
+void test_shared_bottleneck() {
+  auto network = Network();
+
+  // flows 0, 1, and 2 share link 1, whose bandwidth they split equally;
+  // flow 3 shares link 0 with flow 0, and gets what flow 0 leaves of it
+  network.start_flow(0, {0, 1}, size);
+  network.start_flow(1, {2, 1}, size / 3);
+  network.start_flow(2, {3, 1}, size);
+  network.start_flow(3, {0}, size);
+  network.run();
+
+  // 1/3 each on link 1, so flow 1 drains at 1 us, and flow 3 runs at 2/3
+  // until then: equal split on link 0 would be slower
+  check(drains_at(network.drain_times[1], 1), "flow 1 drains at 1 us");
+
+  // then 1/2 each for flows 0 and 2 on link 1, and the other 1/2 of link 0
+  // for flow 3: 1/3 of its size left drains in 2/3 us
+  check(drains_at(network.drain_times[3], 5.0 / 3), "flow 3 drains next");
+
+  // flows 0 and 2 had 2/3 of their size left at 1 us, drained at 1/2
+  check(drains_at(network.drain_times[0], 7.0 / 3), "flow 0 drains last");
+  check(drains_at(network.drain_times[2], 7.0 / 3), "flow 2 drains last");
+  check(
+      network.flow_network->get_active_flows_count() == 0,
+      "every flow drained");
+}
+
+void test_unaffected_flows() {
+  auto network = Network();
+
+  // flow 1 is limited to 1/3 by link 1 (shared with flows 2 and 3), so
+  // flow 0 starting on link 0 takes the other 2/3 and leaves flow 1 at
+  // its rate
+  network.start_flow(1, {0, 1}, size);
+  network.start_flow(2, {1}, size);
+  network.start_flow(3, {1}, size);
+  network.start_flow(0, {0}, size);
+  network.run();
+
+  check(drains_at(network.drain_times[0], 1.5), "flow 0 takes 2/3");
+  check(drains_at(network.drain_times[1], 3), "flow 1 keeps its 1/3");
+  check(drains_at(network.drain_times[2], 3), "flow 2 keeps its 1/3");
+  check(drains_at(network.drain_times[3], 3), "flow 3 keeps its 1/3");
+}
+} // namespace
+
+int main() {
+  test_lone_flow();
+  test_shared_bottleneck();
+  test_unaffected_flows();
+
+  if (failures_count > 0) {
+    std::printf("%d check(s) failed\n", failures_count);
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}
@@ -0,0 +1,268 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "api/AnalyticalNetwork.hh"
+#include "topology/AllToAll.hh"
+
+/**
+ * Test that the parallel engine runs the events of every NPU in the same
+ * order as the sequential engine, including events sharing a time stamp.
+ *
+ * Workload: in each step, every NPU posts a recv from each other NPU,
+ * computes for a while, then sends to each other NPU. Messages share one
+ * latency, and each NPU also schedules local events at the times the sends
+ * of the other NPUs may finish, so recv handlers of sends from the same and
+ * from other partitions tie with each other and with local events.
+ *
+ * Usage: AnalyticalParallelOrderTest (exits with 1 if any check fails)
+ */
+
+namespace {
+using Analytical::AnalyticalNetwork;
+using Analytical::EventQueue;
+using Analytical::ParallelEngine;
+using Analytical::Topology;
+using Analytical::TimeStamp;
+using Analytical::TopologyConfiguration;
+
+constexpr auto npus_count = 8;
+constexpr auto steps_count = 3;
+constexpr auto message_size = 1024;
+
+/**
+ * number of failed checks
+ */
+int failures_count = 0;
+
+void check(bool condition, const char* description) {
+  if (!condition) {
+    std::printf("FAILED: %s\n", description);
+    failures_count++;
+  }
+}
+
+enum class OperationType { compute, send, recv, local };
+
+/**
+ * An event run by an NPU: (time in ns, type, peer, step).
+ */
+using Record = std::tuple<double, OperationType, int, int>;
+
+struct Npu;
+
+/**
+ * An operation whose event handler is recorded when run.
+ */
+struct Operation {
+  Npu* npu;
+  OperationType type;
+  int peer;
+  int step;
+};
+
+/**
+ * An NPU running the exchange steps, recording the events it runs.
+ */
+struct Npu {
+  AnalyticalNetwork* network;
+  TimeStamp latency; // (in ps)
+  int step = 0;
+  int pending_operations_count = 0;
+  std::deque<Operation> operations;
+  std::vector<Record> records;
+
+  void start_step() noexcept {
+    auto rank = network->sim_comm_get_rank();
+    auto compute_offsets = std::vector<TimeStamp>({0, 500, 1000});
+    pending_operations_count =
+        (2 * (npus_count - 1)) + 1 + (int)compute_offsets.size();
+
+    for (auto peer = 0; peer < npus_count; peer++) {
+      if (peer != rank) {
+        network->sim_recv(
+            nullptr,
+            message_size,
+            0,
+            peer,
+            step,
+            nullptr,
+            &Npu::on_event,
+            add_operation(OperationType::recv, peer));
+      }
+    }
+
+    // ties with the recv handlers of the sends issued by other npus
+    for (auto offset : compute_offsets) {
+      schedule(offset + latency, add_operation(OperationType::local, -1));
+    }
+
+    schedule(
+        compute_offsets[(rank + step) % compute_offsets.size()],
+        add_operation(OperationType::compute, -1));
+  }
+
+  Operation* add_operation(OperationType type, int peer) noexcept {
+    operations.push_back({this, type, peer, step});
+    return &operations.back();
+  }
+
+  void schedule(TimeStamp delay, Operation* operation) noexcept {
+    auto delta = AstraSim::timespec_t();
+    delta.time_res = AstraSim::NS;
+    delta.time_val = delay / 1000.0;
+    network->sim_schedule(delta, &Npu::on_event, operation);
+  }
+
+  void send_all() noexcept {
+    auto rank = network->sim_comm_get_rank();
+    for (auto peer = 0; peer < npus_count; peer++) {
+      if (peer != rank) {
+        network->sim_send(
+            nullptr,
+            message_size,
+            0,
+            peer,
+            step,
+            nullptr,
+            &Npu::on_event,
+            add_operation(OperationType::send, peer));
+      }
+    }
+  }
+
+  static void on_event(void* operation_ptr) noexcept {
+    auto operation = static_cast<Operation*>(operation_ptr);
+    auto npu = operation->npu;
+    npu->records.emplace_back(
+        npu->network->sim_get_time().time_val,
+        operation->type,
+        operation->peer,
+        operation->step);
+
+    if (operation->type == OperationType::compute) {
+      npu->send_all();
+    }
+
+    npu->pending_operations_count--;
+    if (npu->pending_operations_count == 0) {
+      npu->step++;
+      if (npu->step < steps_count) {
+        npu->start_step();
+      }
+    }
+  }
+};
+
+/**
+ * Run the workload.
+ * @param threads_count number of threads (1: sequential engine)
+ * @return events run by each npu, in running order
+ */
+std::vector<std::vector<Record>> run(int threads_count) {
+  auto configurations = TopologyConfiguration::TopologyConfigurations();
+  configurations.emplace_back(10, 25, 0, 0, 0, 1000000, 1, 0, 0, 1, 0);
+  auto create_topology = [&]() -> std::shared_ptr<Topology> {
+    return std::make_shared<Analytical::AllToAll>(configurations, npus_count);
+  };
+  auto latency = create_topology()->send(0, 1, message_size);
+
+  auto event_queue = std::make_shared<EventQueue>();
+  AnalyticalNetwork::set_event_queue(event_queue);
+  AnalyticalNetwork::set_topology(create_topology());
+
+  // (set before any network exists)
+  auto parallel_engine = std::shared_ptr<ParallelEngine>();
+  if (threads_count > 1) {
+    parallel_engine = std::make_shared<ParallelEngine>(
+        npus_count,
+        threads_count,
+        EventQueue::SchedulerType::Heap,
+        create_topology);
+  }
+  AnalyticalNetwork::set_parallel_engine(parallel_engine);
+
+  auto networks = std::vector<std::unique_ptr<AnalyticalNetwork>>();
+  auto npus = std::deque<Npu>();
+  for (auto rank = 0; rank < npus_count; rank++) {
+    networks.emplace_back(new AnalyticalNetwork(rank));
+    npus.push_back({networks.back().get(), latency});
+  }
+
+  for (auto& npu : npus) {
+    npu.start_step();
+  }
+  if (parallel_engine != nullptr) {
+    parallel_engine->run();
+  } else {
+    while (!event_queue->empty()) {
+      event_queue->proceed();
+    }
+  }
+
+  auto records = std::vector<std::vector<Record>>();
+  for (const auto& npu : npus) {
+    records.push_back(npu.records);
+  }
+  return records;
+}
+
+/**
+ * @return number of recv events running at the same time as another event
+ *         of their npu
+ */
+int count_recv_ties(const std::vector<std::vector<Record>>& records) {
+  auto ties_count = 0;
+  for (const auto& npu_records : records) {
+    for (size_t i = 0; i < npu_records.size(); i++) {
+      if (std::get<1>(npu_records[i]) != OperationType::recv) {
+        continue;
+      }
+      auto time = std::get<0>(npu_records[i]);
+      if ((i > 0 && std::get<0>(npu_records[i - 1]) == time) ||
+          (i + 1 < npu_records.size() &&
+           std::get<0>(npu_records[i + 1]) == time)) {
+        ties_count++;
+      }
+    }
+  }
+  return ties_count;
+}
+} // namespace
+
+int main() {
+  auto sequential_records = run(1);
+  check(
+      sequential_records.front().size() ==
+          (size_t)(steps_count * ((2 * (npus_count - 1)) + 4)),
+      "every event of the sequential run is recorded");
+  check(
+      count_recv_ties(sequential_records) > 0,
+      "recv events tie with other events");
+
+  for (auto threads_count : {2, 4}) {
+    auto records = run(threads_count);
+    for (auto rank = 0; rank < npus_count; rank++) {
+      if (records[rank] != sequential_records[rank]) {
+        std::printf(
+            "FAILED: %d threads, npu %d: events run in another order\n",
+            threads_count,
+            rank);
+        failures_count++;
+      }
+    }
+  }
+
+  if (failures_count > 0) {
+    std::printf("%d check(s) failed\n", failures_count);
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}
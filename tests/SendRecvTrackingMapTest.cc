@@ -0,0 +1,232 @@
+/******************************************************************************
+This source code is licensed under the MIT license found in the
+LICENSE file in the root directory of this source tree.
+*******************************************************************************/
+
+#include <cstdio>
+#include <vector>
+#include "api/SendRecvTrackingMap.hh"
+
+/**
+ * Tests of SendRecvTrackingMap matching: FIFO order of operations sharing
+ * a key, wildcard (any_source / any_tag) recv operations, and event keys
+ * of matched operations.
+ *
+ * Usage: AnalyticalSendRecvTrackingMapTest (exits with 1 if any check fails)
+ */
+
+namespace {
+using Analytical::Event;
+using Analytical::EventKey;
+using Analytical::SendRecvTrackingMap;
+using Analytical::TimeStamp;
+
+constexpr auto any_source = SendRecvTrackingMap::any_source;
+constexpr auto any_tag = SendRecvTrackingMap::any_tag;
+
+/**
+ * number of failed checks
+ */
+int failures_count = 0;
+
+void check(bool condition, const char* description) {
+  if (!condition) {
+    std::printf("FAILED: %s\n", description);
+    failures_count++;
+  }
+}
+
+/**
+ * Recv event handlers log the id of their recv operation when run.
+ */
+struct Log {
+  std::vector<int> recv_ids;
+
+  Event recv_event(int recv_id) {
+    return Event([this, recv_id]() { recv_ids.push_back(recv_id); });
+  }
+};
+
+/**
+ * Post a send operation, running the matched recv event handler.
+ * @return whether a recv operation is matched
+ */
+bool post_send(
+    SendRecvTrackingMap& map,
+    int tag,
+    int src,
+    TimeStamp post_time,
+    TimeStamp send_finish_time) {
+  auto recv_event = Event();
+  auto recv_key = EventKey();
+  auto matched = map.match_or_insert_send(
+      tag,
+      src,
+      0,
+      1,
+      post_time,
+      send_finish_time,
+      {post_time, src, 0},
+      recv_event,
+      recv_key);
+  if (matched) {
+    recv_event.run();
+  }
+  return matched;
+}
+
+/**
+ * Post a recv operation.
+ * @return send_finish_time of the matched send operation, -1 if tracked
+ */
+TimeStamp post_recv(
+    SendRecvTrackingMap& map,
+    Log& log,
+    int recv_id,
+    int tag,
+    int src,
+    TimeStamp post_time,
+    int count = 1) {
+  auto send_finish_time = (TimeStamp)0;
+  auto send_key = EventKey();
+  auto matched = map.match_or_insert_recv(
+      tag,
+      src,
+      0,
+      count,
+      post_time,
+      log.recv_event(recv_id),
+      {post_time, 0, (uint32_t)recv_id},
+      send_finish_time,
+      send_key);
+  return matched ? send_finish_time : -1;
+}
+
+void test_fifo() {
+  auto map = SendRecvTrackingMap();
+  auto log = Log();
+
+  // sends sharing a key are matched in posting order
+  post_send(map, 7, 1, 0, 30);
+  post_send(map, 7, 1, 1, 10);
+  post_send(map, 7, 1, 2, 20);
+  check(map.size() == 3, "sends are tracked");
+  check(post_recv(map, log, 0, 7, 1, 3) == 30, "1st recv matches 1st send");
+  check(post_recv(map, log, 1, 7, 1, 4) == 10, "2nd recv matches 2nd send");
+  check(post_recv(map, log, 2, 7, 1, 5) == 20, "3rd recv matches 3rd send");
+
+  // recvs sharing a key are matched in posting order
+  for (auto recv_id = 10; recv_id < 13; recv_id++) {
+    check(post_recv(map, log, recv_id, 7, 1, 6) == -1, "recv is tracked");
+  }
+  for (auto send_id = 0; send_id < 3; send_id++) {
+    check(post_send(map, 7, 1, 7, 8), "send matches a tracked recv");
+  }
+  check(
+      log.recv_ids == std::vector<int>({10, 11, 12}),
+      "recvs are matched in posting order");
+  check(map.size() == 0, "every operation is matched");
+}
+
+void test_wildcard_recv() {
+  auto map = SendRecvTrackingMap();
+  auto log = Log();
+
+  // any_source: the send arriving first is matched, whatever its src
+  post_send(map, 7, 2, 0, 50);
+  post_send(map, 7, 1, 1, 30);
+  post_send(map, 8, 3, 2, 10);
+  check(
+      post_recv(map, log, 0, 7, any_source, 3) == 30,
+      "any_source matches the earliest arriving send of the tag");
+  check(
+      post_recv(map, log, 1, 7, any_source, 4) == 50,
+      "any_source then matches the next arriving send");
+
+  // any_tag: the send arriving first from src is matched, whatever its tag
+  post_send(map, 9, 3, 5, 5);
+  check(
+      post_recv(map, log, 2, any_tag, 3, 6) == 5,
+      "any_tag matches the earliest arriving send of the src");
+
+  // any_source and any_tag, with a count no pending send has
+  check(
+      post_recv(map, log, 3, any_tag, any_source, 7, 2) == -1,
+      "wildcard recv still requires the same count");
+  check(
+      post_recv(map, log, 4, any_tag, any_source, 8) == 10,
+      "any_source and any_tag matches the remaining send");
+  check(map.size() == 1, "only the recv with count 2 is pending");
+}
+
+void test_send_matches_earliest_recv() {
+  auto map = SendRecvTrackingMap();
+  auto log = Log();
+
+  // a send matches the earliest posted recv among exact and wildcard ones
+  post_recv(map, log, 0, any_tag, any_source, 0);
+  post_recv(map, log, 1, 7, 1, 1);
+  post_recv(map, log, 2, 7, any_source, 2);
+  post_send(map, 7, 1, 3, 4);
+  post_send(map, 7, 1, 5, 6);
+  post_send(map, 7, 1, 7, 8);
+  check(
+      log.recv_ids == std::vector<int>({0, 1, 2}),
+      "sends match recvs in posting order across wildcards");
+  check(map.size() == 0, "every operation is matched");
+}
+} // namespace
+
+void test_event_keys() {
+  auto map = SendRecvTrackingMap();
+  auto log = Log();
+
+  // the matching operation reports the event key it was posted with
+  auto send_finish_time = (TimeStamp)0;
+  auto send_key = EventKey();
+  auto recv_event = Event();
+  auto recv_key = EventKey();
+  map.match_or_insert_recv(
+      7, 1, 0, 1, 5, log.recv_event(0), {5, 0, 3}, send_finish_time, send_key);
+  check(
+      map.match_or_insert_send(
+          7, 1, 0, 1, 6, 9, {6, 1, 2}, recv_event, recv_key),
+      "send matches the tracked recv");
+  check(
+      recv_key.issue_time == 5 && recv_key.issuer == 0 &&
+          recv_key.sequence == 3,
+      "send gets the key of the recv");
+
+  map.match_or_insert_send(
+      7, 1, 0, 1, 10, 20, {10, 1, 4}, recv_event, recv_key);
+  check(
+      map.match_or_insert_recv(
+          7,
+          1,
+          0,
+          1,
+          11,
+          log.recv_event(1),
+          {11, 0, 5},
+          send_finish_time,
+          send_key),
+      "recv matches the tracked send");
+  check(
+      send_finish_time == 20 && send_key.issue_time == 10 &&
+          send_key.issuer == 1 && send_key.sequence == 4,
+      "recv gets the key of the send");
+}
+
+int main() {
+  test_fifo();
+  test_wildcard_recv();
+  test_send_matches_earliest_recv();
+  test_event_keys();
+
+  if (failures_count > 0) {
+    std::printf("%d check(s) failed\n", failures_count);
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}